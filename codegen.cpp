@@ -0,0 +1,252 @@
+/**
+ * Kernel Generator
+ *
+ * Emits header-only C++ functions with fully unrolled product, sandwich and
+ * involution formulas for fixed blade sets, derived from Multivector::sign so
+ * that they agree with the reference implementation:
+ *
+ *     ./codegen <signature> <lhs> <rhs> > kernels.h
+ *
+ * <signature> is one of euclidean2, euclidean3, euclidean4, spacetime or
+ * projective.
+ * A blade set is either a name (scalar, vector, bivector, trivector,
+ * pseudoscalar, even, rotor, odd, full) or a comma-separated list of masks.
+ *
+ * Each operand is a float array holding the coefficients of its blade set in
+ * the order listed in the generated comments. Terms are collected
+ * symbolically, so products that always cancel are never emitted.
+ */
+
+#include "multivector.h"
+
+#include <charconv>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+template <class Signature>
+class KernelGenerator {
+public:
+    using V = Multivector<Signature>;
+
+    // A monomial is a sorted list of variable ids: lhs coefficient i is i, rhs coefficient j is lhs.size() + j.
+    using Monomial = std::vector<size_t>;
+    using Polynomial = std::map<Monomial, int>;
+    using Result = std::map<uint64_t, Polynomial>;
+
+    static std::vector<uint64_t> blade_set(const std::string &spec) {
+        constexpr size_t n = Signature::max_dimension();
+        auto grades = [](auto keep) {
+            std::vector<uint64_t> masks;
+            for (uint64_t mask = 0; mask < (1ULL << n); mask++) {
+                if (keep(static_cast<size_t>(__builtin_popcountll(mask)))) {
+                    masks.push_back(mask);
+                }
+            }
+            return masks;
+        };
+
+        if (spec == "scalar") return grades([](size_t g) { return g == 0; });
+        if (spec == "vector") return grades([](size_t g) { return g == 1; });
+        if (spec == "bivector") return grades([](size_t g) { return g == 2; });
+        if (spec == "trivector") return grades([](size_t g) { return g == 3; });
+        if (spec == "pseudoscalar") return grades([](size_t g) { return g == n; });
+        if (spec == "even" || spec == "rotor") return grades([](size_t g) { return g % 2 == 0; });
+        if (spec == "odd") return grades([](size_t g) { return g % 2 == 1; });
+        if (spec == "full") return grades([](size_t) { return true; });
+
+        std::vector<uint64_t> masks;
+        std::stringstream ss(spec);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            uint64_t mask = 0;
+            auto [end, ec] = std::from_chars(item.data(), item.data() + item.size(), mask);
+            if (item.empty() || ec != std::errc() || end != item.data() + item.size()) {
+                throw std::invalid_argument("Blade '" + item + "' in " + spec + " is not a mask or grade name");
+            }
+            if (mask >= (1ULL << n)) {
+                throw std::invalid_argument("Blade " + item + " outside of signature bounds");
+            }
+            if (std::find(masks.begin(), masks.end(), mask) != masks.end()) {
+                throw std::invalid_argument("Blade " + item + " repeated in " + spec);
+            }
+            masks.push_back(mask);
+        }
+        return masks;
+    }
+
+    static int32_t reverse_sign(uint64_t mask) {
+        uint64_t grade = __builtin_popcountll(mask);
+        return (grade * (grade - 1) / 2) % 2 ? -1 : 1;
+    }
+
+    static int32_t involute_sign(uint64_t mask) {
+        return __builtin_popcountll(mask) % 2 ? -1 : 1;
+    }
+
+    // lhs * rhs
+    static Result product(const std::vector<uint64_t> &lhs, const std::vector<uint64_t> &rhs) {
+        Result result;
+        for (size_t i = 0; i < lhs.size(); i++) {
+            for (size_t j = 0; j < rhs.size(); j++) {
+                add(result, lhs[i] ^ rhs[j], {i, lhs.size() + j}, V::sign(lhs[i], rhs[j]));
+            }
+        }
+        return prune(result);
+    }
+
+    // lhs * rhs * ~lhs
+    static Result sandwich(const std::vector<uint64_t> &lhs, const std::vector<uint64_t> &rhs) {
+        Result result;
+        for (size_t i = 0; i < lhs.size(); i++) {
+            for (size_t j = 0; j < rhs.size(); j++) {
+                uint64_t middle = lhs[i] ^ rhs[j];
+                int32_t s = V::sign(lhs[i], rhs[j]);
+                for (size_t k = 0; k < lhs.size(); k++) {
+                    add(result, middle ^ lhs[k], {std::min(i, k), std::max(i, k), lhs.size() + j},
+                        s * V::sign(middle, lhs[k]) * reverse_sign(lhs[k]));
+                }
+            }
+        }
+        return prune(result);
+    }
+
+    static void emit_binary(std::ostream &os, const std::string &name, size_t lhs_size, const Result &result) {
+        os << "// out: " << layout(result) << "\n";
+        os << "inline void " << name << "(const float *a, const float *b, float *out) {\n";
+        size_t index = 0;
+        for (const auto &[mask, polynomial] : result) {
+            os << "    out[" << index++ << "] = " << expression(polynomial, lhs_size) << ";\n";
+        }
+        os << "}\n\n";
+    }
+
+    static void emit_involution(std::ostream &os, const std::string &name, const std::vector<uint64_t> &lhs,
+                                int32_t (*sign)(uint64_t)) {
+        os << "inline void " << name << "(const float *a, float *out) {\n";
+        for (size_t i = 0; i < lhs.size(); i++) {
+            os << "    out[" << i << "] = " << (sign(lhs[i]) < 0 ? "-" : "") << "a[" << i << "];\n";
+        }
+        os << "}\n\n";
+    }
+
+    static void generate(std::ostream &os, const std::string &prefix, const std::string &lhs_spec,
+                         const std::string &rhs_spec) {
+        const auto lhs = blade_set(lhs_spec);
+        const auto rhs = blade_set(rhs_spec);
+        const std::string name = prefix + "_" + identifier(lhs_spec) + "_" + identifier(rhs_spec);
+
+        os << "// Generated by codegen " << prefix << " " << lhs_spec << " " << rhs_spec << ". Do not edit.\n";
+        os << "// a: " << layout(lhs) << "\n";
+        os << "// b: " << layout(rhs) << "\n\n";
+        os << "#pragma once\n\n";
+
+        emit_binary(os, name + "_product", lhs.size(), product(lhs, rhs));
+        emit_binary(os, name + "_sandwich", lhs.size(), sandwich(lhs, rhs));
+
+        const std::string unary = prefix + "_" + identifier(lhs_spec);
+        emit_involution(os, unary + "_reverse", lhs, reverse_sign);
+        emit_involution(os, unary + "_involute", lhs, involute_sign);
+        emit_involution(os, unary + "_conjugate", lhs, [](uint64_t mask) {
+            return reverse_sign(mask) * involute_sign(mask);
+        });
+    }
+
+private:
+    static void add(Result &result, uint64_t mask, Monomial monomial, int32_t s) {
+        std::sort(monomial.begin(), monomial.end());
+        result[mask][monomial] += s;
+    }
+
+    static Result prune(const Result &result) {
+        Result pruned;
+        for (const auto &[mask, polynomial] : result) {
+            for (const auto &[monomial, coeff] : polynomial) {
+                if (coeff != 0) {
+                    pruned[mask][monomial] = coeff;
+                }
+            }
+        }
+        return pruned;
+    }
+
+    static std::string variable(size_t id, size_t lhs_size) {
+        return id < lhs_size ? "a[" + std::to_string(id) + "]" : "b[" + std::to_string(id - lhs_size) + "]";
+    }
+
+    static std::string expression(const Polynomial &polynomial, size_t lhs_size) {
+        std::string text;
+        for (const auto &[monomial, coeff] : polynomial) {
+            if (text.empty()) {
+                text += coeff < 0 ? "-" : "";
+            } else {
+                text += coeff < 0 ? " - " : " + ";
+            }
+            if (std::abs(coeff) != 1) {
+                text += std::to_string(std::abs(coeff)) + " * ";
+            }
+            for (size_t i = 0; i < monomial.size(); i++) {
+                text += (i > 0 ? " * " : "") + variable(monomial[i], lhs_size);
+            }
+        }
+        return text;
+    }
+
+    static std::string layout(const std::vector<uint64_t> &masks) {
+        std::string text;
+        for (uint64_t mask : masks) {
+            text += (text.empty() ? "" : " ") + std::string("e(") + std::to_string(mask) + ")";
+        }
+        return text;
+    }
+
+    static std::string layout(const Result &result) {
+        std::vector<uint64_t> masks;
+        for (const auto &entry : result) {
+            masks.push_back(entry.first);
+        }
+        return layout(masks);
+    }
+
+    static std::string identifier(const std::string &spec) {
+        std::string id = spec;
+        std::replace(id.begin(), id.end(), ',', '_');
+        return std::isdigit(static_cast<unsigned char>(id[0])) ? "set" + id : id;
+    }
+};
+
+static void usage(const char *program) {
+    std::cerr << "usage: " << program << " <signature> <lhs> <rhs>" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 4) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const std::string signature = argv[1];
+    try {
+        if (signature == "euclidean2") {
+            KernelGenerator<EuclideanSignature<2>>::generate(std::cout, signature, argv[2], argv[3]);
+        } else if (signature == "euclidean3") {
+            KernelGenerator<EuclideanSignature<3>>::generate(std::cout, signature, argv[2], argv[3]);
+        } else if (signature == "euclidean4") {
+            KernelGenerator<EuclideanSignature<4>>::generate(std::cout, signature, argv[2], argv[3]);
+        } else if (signature == "spacetime") {
+            KernelGenerator<MinkowskiSignature>::generate(std::cout, signature, argv[2], argv[3]);
+        } else if (signature == "projective") {
+            KernelGenerator<ProjectiveSignature>::generate(std::cout, signature, argv[2], argv[3]);
+        } else {
+            std::cerr << "unknown signature: " << signature << std::endl;
+            return 1;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        usage(argv[0]);
+        return 1;
+    }
+    return 0;
+}
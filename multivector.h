@@ -0,0 +1,4946 @@
+/**
+ * Geometric algebra multivector library.
+ *
+ * Multivector<Signature> stores a multivector as a list of blades, each a
+ * coefficient and a bitmask of the basis vectors it contains. Signature
+ * policies describe the metric; the rest of this header adds alternative
+ * product kernels, batch execution and serialization on top of it.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <span>
+#include <istream>
+#include <string>
+#include <cstring>
+#include <stdexcept>
+#include <charconv>
+#include <string_view>
+#include <system_error>
+#include <memory>
+#include <shared_mutex>
+#include <utility>
+#include <complex>
+#include <map>
+#include <typeinfo>
+#include <bitset>
+#include <exception>
+#if defined(__SSE__)
+#include <immintrin.h>
+#endif
+#include <cxxabi.h>
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Metric signatures.
+ *
+ * value(i) selects the square of basis vector i: 0 for +1 and 1 for -1.
+ * Both are measured against the identity, which Multivector::sign() makes
+ * -e(0), so a vector with value 1 prints as `1 * e(0)` when squared.
+ * EuclideanSignature<N> is Cl(0,N) in this encoding and MinkowskiSignature
+ * is Cl(3,1) with e(1) as the timelike vector; signature_name() reports
+ * every signature as Cl(p,q,r) the same way.
+ */
+template <size_t Dimension>
+struct EuclideanSignature {
+    static constexpr size_t max_dimension() {
+        return Dimension;
+    }
+
+    static constexpr uint32_t value(std::size_t) {
+        return 1;
+    }
+};
+
+struct MinkowskiSignature {
+    static constexpr int32_t signature[4] = {1, 0, 0, 0};
+
+    static constexpr size_t max_dimension() {
+        return 4;
+    }
+
+    static constexpr int32_t value(size_t i) {
+        assert(i < max_dimension() && "Index outside of signature bounds");
+        return signature[i];
+    }
+};
+
+/**
+ * Projective signature (0,3,1): e(1), e(2) and e(4) square to -1 like the
+ * vectors of EuclideanSignature, and e(8) is the degenerate basis vector.
+ * The even subalgebra, where motors live, matches that of (3,0,1): lines
+ * still square to -1 and translations to 0.
+ *
+ * A signature may declare degenerate(i) for basis vectors that square to
+ * zero; Multivector::sign() then returns 0 for products repeating them.
+ */
+struct ProjectiveSignature {
+    static constexpr size_t max_dimension() {
+        return 4;
+    }
+
+    static constexpr int32_t value([[maybe_unused]] size_t i) {
+        assert(i < max_dimension() && "Index outside of signature bounds");
+        return 1;
+    }
+
+    static constexpr bool degenerate(size_t i) {
+        return i == 3;
+    }
+};
+
+/**
+ * Conformal signature Cl(4,1): e(1), e(2), e(4) and e(8) have value 0 and
+ * square to +1, e(16) has value 1 and squares to -1. ConformalVector works
+ * in the null basis built from the last two.
+ */
+struct ConformalSignature {
+    static constexpr int32_t signature[5] = {0, 0, 0, 0, 1};
+
+    static constexpr size_t max_dimension() {
+        return 5;
+    }
+
+    static constexpr int32_t value(size_t i) {
+        assert(i < max_dimension() && "Index outside of signature bounds");
+        return signature[i];
+    }
+};
+
+// Whether basis vector i of Signature squares to zero.
+template <class Signature>
+constexpr bool is_degenerate(size_t i) {
+    if constexpr (requires { Signature::degenerate(i); }) {
+        return Signature::degenerate(i);
+    } else {
+        return false;
+    }
+}
+
+template <class Signature>
+constexpr bool has_degenerate_metric() {
+    for (size_t i = 0; i < Signature::max_dimension(); i++) {
+        if (is_degenerate<Signature>(i)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Pruning of cancelled blades.
+ *
+ * A blade whose coefficient is negligible under `mode` and `epsilon` is
+ * removed by Multivector::compact(). With `automatic` set, the results of
+ * sums, differences and products are compacted before they are returned.
+ * The default only removes coefficients that cancelled to exactly zero.
+ */
+struct Compaction {
+    enum class Mode {
+        Exact,     // |c| == 0
+        Absolute,  // |c| <= epsilon
+        Relative,  // |c| <= epsilon * largest |c| of the multivector
+    };
+
+    struct Statistics {
+        uint64_t compactions;
+        uint64_t pruned;
+    };
+
+    inline static Mode mode = Mode::Exact;
+    inline static float epsilon = 0.0f;
+    inline static bool automatic = true;
+
+    static float threshold(float largest) {
+        switch (mode) {
+            case Mode::Absolute: return epsilon;
+            case Mode::Relative: return epsilon * largest;
+            default: return 0.0f;
+        }
+    }
+
+    static void record(size_t pruned) {
+        s_compactions.fetch_add(1, std::memory_order_relaxed);
+        s_pruned.fetch_add(pruned, std::memory_order_relaxed);
+    }
+
+    // Only passes that removed at least one blade are counted.
+    static Statistics statistics() {
+        return {s_compactions.load(std::memory_order_relaxed), s_pruned.load(std::memory_order_relaxed)};
+    }
+
+    static void reset_statistics() {
+        s_compactions.store(0, std::memory_order_relaxed);
+        s_pruned.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    inline static std::atomic<uint64_t> s_compactions{0};
+    inline static std::atomic<uint64_t> s_pruned{0};
+};
+
+/**
+ * Scoped tracing of kernels, exported as Chrome / Perfetto trace JSON.
+ *
+ * Compiled in only with -DMULTIVECTOR_TRACE; otherwise the span macros
+ * expand to nothing. Each traced thread appends to its own fixed-size ring
+ * buffer with a single release store per event, so recording takes no lock
+ * and the oldest events are overwritten once the buffer is full. Timestamps
+ * are TSC ticks, converted to microseconds at export against the steady
+ * clock. Export after the traced work has finished.
+ */
+class Tracer {
+public:
+    struct Event {
+        const char *name;
+        uint64_t start;
+        uint64_t end;
+        // Operand and result blade counts, or item counts for batch kernels.
+        uint32_t lhs;
+        uint32_t rhs;
+        uint32_t result;
+    };
+
+    static constexpr size_t capacity = size_t(1) << 16;
+
+    class Buffer {
+    public:
+        explicit Buffer(uint32_t thread) : m_thread(thread), m_events(capacity) {}
+
+        void push(const Event &event) {
+            const uint64_t head = m_head.load(std::memory_order_relaxed);
+            m_events[head % capacity] = event;
+            m_head.store(head + 1, std::memory_order_release);
+        }
+
+    private:
+        friend class Tracer;
+
+        uint32_t m_thread;
+        std::vector<Event> m_events;
+        std::atomic<uint64_t> m_head{0};
+    };
+
+    static Tracer &instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __builtin_ia32_rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // Buffer of the calling thread, registered on first use and kept alive
+    // after the thread exits so that its events can still be exported.
+    Buffer &buffer() {
+        thread_local std::shared_ptr<Buffer> local = [this] {
+            auto created = std::make_shared<Buffer>(static_cast<uint32_t>(syscall(SYS_gettid)));
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_buffers.push_back(created);
+            return created;
+        }();
+        return *local;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &b : m_buffers) {
+            b->m_head.store(0, std::memory_order_release);
+        }
+    }
+
+    void export_chrome(std::ostream &os) {
+        const double ticks_per_us = calibrate();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        os << "{\"traceEvents\":[";
+        bool first = true;
+        for (const auto &b : m_buffers) {
+            const uint64_t head = b->m_head.load(std::memory_order_acquire);
+            for (uint64_t i = head > capacity ? head - capacity : 0; i < head; i++) {
+                const Event &e = b->m_events[i % capacity];
+                // Clamped so that a start before the origin cannot wrap around.
+                const uint64_t offset = e.start > m_origin_ticks ? e.start - m_origin_ticks : 0;
+                os << (first ? "" : ",") << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                   << b->m_thread << ",\"ts\":" << static_cast<double>(offset) / ticks_per_us
+                   << ",\"dur\":" << static_cast<double>(e.end - e.start) / ticks_per_us << ",\"args\":{\"lhs\":"
+                   << e.lhs << ",\"rhs\":" << e.rhs << ",\"result\":" << e.result << "}}";
+                first = false;
+            }
+        }
+        os << "]}";
+    }
+
+private:
+    Tracer() : m_origin_ticks(now()), m_origin_time(std::chrono::steady_clock::now()) {}
+
+    // Ticks per microsecond over the lifetime of the tracer, at least 1 ms.
+    double calibrate() const {
+        uint64_t ticks;
+        std::chrono::steady_clock::duration elapsed;
+        do {
+            ticks = now();
+            elapsed = std::chrono::steady_clock::now() - m_origin_time;
+        } while (elapsed < std::chrono::milliseconds(1));
+        const double us = std::chrono::duration<double, std::micro>(elapsed).count();
+        return static_cast<double>(ticks - m_origin_ticks) / us;
+    }
+
+    const uint64_t m_origin_ticks;
+    const std::chrono::steady_clock::time_point m_origin_time;
+    std::mutex m_mutex;
+    std::vector<std::shared_ptr<Buffer>> m_buffers;
+};
+
+// Records one Tracer::Event for its scope; `name` must outlive the export.
+class TraceSpan {
+public:
+    // The tracer is built before the start tick is read, so that the first
+    // span of the process does not start before the tracer's origin.
+    TraceSpan(const char *name, size_t lhs, size_t rhs)
+        : m_tracer(Tracer::instance()),
+          m_event{name, Tracer::now(), 0, static_cast<uint32_t>(lhs), static_cast<uint32_t>(rhs), 0} {}
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+    void result(size_t size) {
+        m_event.result = static_cast<uint32_t>(size);
+    }
+
+    ~TraceSpan() {
+        m_event.end = Tracer::now();
+        m_tracer.buffer().push(m_event);
+    }
+
+private:
+    Tracer &m_tracer;
+    Tracer::Event m_event;
+};
+
+#if defined(MULTIVECTOR_TRACE)
+#define MULTIVECTOR_TRACE_SPAN(span, name, lhs, rhs) TraceSpan span(name, lhs, rhs)
+#define MULTIVECTOR_TRACE_RESULT(span, size) span.result(size)
+#else
+#define MULTIVECTOR_TRACE_SPAN(span, name, lhs, rhs) ((void)0)
+#define MULTIVECTOR_TRACE_RESULT(span, size) ((void)0)
+#endif
+
+/**
+ * Switching between the sparse and dense representations of Multivector.
+ *
+ * Sparse keeps the non-zero blades in insertion order and finds a blade by
+ * search, which degrades as a multivector fills up. Dense keeps one
+ * coefficient per mask and indexes it directly. With `automatic` set, a
+ * multivector of at most `max_dimension` dimensions turns dense once more
+ * than `dense_fill` of its 2^N blades are present, including in the middle
+ * of a product, and turns sparse again (in ascending mask order) after an
+ * operation leaves fewer than `sparse_fill` of them. The gap between the two
+ * thresholds keeps it from flapping.
+ *
+ * Up to `sign_table_dimension` dimensions the dense product reads its signs
+ * from a 4^N table built on first use; above that it computes them per pair.
+ */
+struct Representation {
+    static constexpr size_t max_dimension = 16;
+    static constexpr size_t sign_table_dimension = 10;
+
+    inline static float dense_fill = 0.5f;
+    inline static float sparse_fill = 0.25f;
+    inline static bool automatic = true;
+};
+
+// Smallest unsigned integer that holds every blade mask of an N-dimensional signature.
+template <size_t N>
+using BladeMask = std::conditional_t<N <= 8, uint8_t,
+                  std::conditional_t<N <= 16, uint16_t,
+                  std::conditional_t<N <= 32, uint32_t, uint64_t>>>;
+
+template <class Signature>
+class MatrixMultivector;
+
+template <class Signature>
+class BinarySerializer;
+
+template <class Signature>
+class TextFormat;
+
+template <class Signature>
+class ProductPlan;
+
+template <class Signature, uint64_t... Masks>
+class StaticMultivector;
+
+template <class Signature>
+class MultivectorBatch;
+
+template <class Signature>
+class Even;
+
+template <class Signature, size_t Capacity>
+class FixedMultivector;
+
+class ConformalTransform;
+class LorentzTransform;
+struct BlockProduct;
+struct ParallelProduct;
+
+template <class Accumulator>
+struct AccumulatedProduct;
+
+template <class Signature>
+class Multivector {
+private:
+    struct Blade {
+        float coefficient;
+        uint64_t mask;
+
+        friend std::ostream& operator<<(std::ostream& os, const Blade &b) {
+            os << b.coefficient << " * e(" << b.mask << ")";
+            return os;
+        }
+    };
+
+public:
+    static Multivector create(const std::initializer_list<Blade>& blades) {
+        Multivector v;
+        for (const auto &b : blades) {
+            v.add_blade(b.coefficient, b.mask);
+        }
+        return v;
+    }
+
+    static Multivector basis_vector(uint64_t i) {
+        assert(i < Signature::max_dimension() && "Basis vector index exceed maximum value");
+        Multivector v;
+        v.add_blade(1.0f, 1ULL << i);
+        return v;
+    }
+
+    Multivector operator+(const Multivector &other) const {
+        MULTIVECTOR_TRACE_SPAN(span, "operator+", size(), other.size());
+        Multivector result = *this;
+        for (const auto &b : other.blades()) {
+            result.add_blade(b.coefficient, b.mask);
+        }
+        result.auto_compact();
+        MULTIVECTOR_TRACE_RESULT(span, result.size());
+        return result;
+    }
+
+    Multivector operator-(const Multivector &other) const {
+        Multivector result = *this;
+        for (const auto &b : other.blades()) {
+            result.add_blade(-b.coefficient, b.mask);
+        }
+        result.auto_compact();
+        return result;
+    }
+
+    Multivector operator*(float scalar) const {
+        Multivector result = empty_like();
+        for (const auto &b : blades()) {
+            result.add_blade(scalar * b.coefficient, b.mask);
+        }
+        result.auto_compact();
+        return result;
+    }
+
+    Multivector operator*(const Multivector &other) const {
+        MULTIVECTOR_TRACE_SPAN(span, "operator*", size(), other.size());
+        Multivector result;
+        if (!dense() && !other.dense()) {
+            for (size_t i = 0; i < m_masks.size(); i++) {
+                for (size_t j = 0; j < other.m_masks.size(); j++) {
+                    uint64_t new_mask = m_masks[i] ^ other.m_masks[j];
+                    int32_t s = sign(m_masks[i], other.m_masks[j]);
+                    float new_coeff = m_coefficients[i] * other.m_coefficients[j] * s;
+                    result.add_blade(new_coeff, new_mask);
+                }
+            }
+        } else if (dense() && other.dense()) {
+            result.make_dense();
+            multiply_dense(m_dense.data(), other.m_dense.data(), result.m_dense.data());
+        } else {
+            // One dense operand: accumulate straight into a dense result.
+            result.make_dense();
+            for (const auto &a : blades()) {
+                for (const auto &b : other.blades()) {
+                    result.m_dense[a.mask ^ b.mask] += a.coefficient * b.coefficient * sign(a.mask, b.mask);
+                }
+            }
+        }
+        result.auto_compact();
+        MULTIVECTOR_TRACE_RESULT(span, result.size());
+        return result;
+    }
+
+    Multivector reverse() const {
+        MULTIVECTOR_TRACE_SPAN(span, "reverse", size(), 0);
+        Multivector result = *this;
+        result.reverse_in_place();
+        MULTIVECTOR_TRACE_RESULT(span, result.size());
+        return result;
+    }
+
+    Multivector operator~() const {
+        return reverse();
+    }
+
+    // Grade involution: negates the odd grades.
+    Multivector involute() const {
+        Multivector result = *this;
+        result.involute_in_place();
+        return result;
+    }
+
+    // Clifford conjugate, the reverse of the grade involution.
+    Multivector conjugate() const {
+        Multivector result = *this;
+        result.conjugate_in_place();
+        return result;
+    }
+
+    Multivector &reverse_in_place() {
+        apply_involution<reverse_grades>();
+        return *this;
+    }
+
+    Multivector &involute_in_place() {
+        apply_involution<involute_grades>();
+        return *this;
+    }
+
+    Multivector &conjugate_in_place() {
+        apply_involution<conjugate_grades>();
+        return *this;
+    }
+
+    // The e(0) coefficient of A * B, without forming the product. Only blades
+    // with equal masks meet at e(0). Small sparse operands are scanned pairwise;
+    // past merge_threshold pairs, the blade sets are sorted and merged by mask.
+    static constexpr size_t merge_threshold = 256;
+
+    static float scalar_product(const Multivector &A, const Multivector &B) {
+        float sum = 0.0f;
+        if (A.dense() && B.dense()) {
+            if constexpr (dense_capable()) {
+                const std::vector<float> &signs = square_signs<false>();
+                for (size_t i = 0; i < dense_size; i++) {
+                    sum += signs[i] * A.m_dense[i] * B.m_dense[i];
+                }
+            }
+            return sum;
+        }
+        if (A.dense() || B.dense()) {
+            const Multivector &dense = A.dense() ? A : B, &sparse = A.dense() ? B : A;
+            for (size_t i = 0; i < sparse.m_masks.size(); i++) {
+                const uint64_t mask = sparse.m_masks[i];
+                sum += static_cast<float>(sign(mask, mask)) * sparse.m_coefficients[i] * dense.m_dense[mask];
+            }
+            return sum;
+        }
+        if (A.m_masks.size() * B.m_masks.size() <= merge_threshold) {
+            for (size_t i = 0; i < A.m_masks.size(); i++) {
+                const uint64_t x = A.m_masks[i];
+                for (size_t j = 0; j < B.m_masks.size(); j++) {
+                    if (B.m_masks[j] == x) {
+                        sum += static_cast<float>(sign(x, x)) * A.m_coefficients[i] * B.m_coefficients[j];
+                        break;
+                    }
+                }
+            }
+            return sum;
+        }
+        const std::vector<uint32_t> a = A.mask_order(), b = B.mask_order();
+        for (size_t i = 0, j = 0; i < a.size() && j < b.size();) {
+            const uint64_t x = A.m_masks[a[i]], y = B.m_masks[b[j]];
+            if (x < y) {
+                i++;
+            } else if (y < x) {
+                j++;
+            } else {
+                sum += static_cast<float>(sign(x, x)) * A.m_coefficients[a[i++]] * B.m_coefficients[b[j++]];
+            }
+        }
+        return sum;
+    }
+
+    // The e(0) coefficient of A * ~A, one term per blade. e(0) is minus the
+    // identity, so scalars and unit rotors give -1 while unit vectors of
+    // EuclideanSignature, whose basis vectors square to -1, give +1; mixed
+    // metrics give either sign. norm() takes the magnitude.
+    float norm2() const {
+        float sum = 0.0f;
+        if (dense()) {
+            if constexpr (dense_capable()) {
+                const std::vector<float> &signs = square_signs<true>();
+                for (size_t i = 0; i < dense_size; i++) {
+                    sum += signs[i] * m_dense[i] * m_dense[i];
+                }
+            }
+            return sum;
+        }
+        for (size_t i = 0; i < m_masks.size(); i++) {
+            sum += versor_weight(m_masks[i], m_masks[i]) * m_coefficients[i] * m_coefficients[i];
+        }
+        return sum;
+    }
+
+    // sqrt(|norm2()|).
+    float norm() const {
+        return std::sqrt(std::fabs(norm2()));
+    }
+
+    // Versor normalization R / sqrt(R * ~R). For a versor only the scalar part
+    // of R * ~R survives, plus the pseudoscalar part in 4D, so only those are
+    // computed. The result squares to plus or minus one under R * ~R.
+    Multivector normalize() const {
+        const float scalar = norm2();
+
+        float pseudoscalar = 0.0f;
+        if constexpr (Signature::max_dimension() == 4) {
+            constexpr uint64_t I = 0xF;
+            std::array<float, 16> dense{};
+            for (const auto &b : blades()) {
+                dense[b.mask] += b.coefficient;
+            }
+            for (const auto &b : blades()) {
+                pseudoscalar += versor_weight(b.mask, I ^ b.mask) * b.coefficient * dense[I ^ b.mask];
+            }
+        }
+
+        auto [alpha, beta] = inverse_sqrt(scalar, pseudoscalar);
+        if (beta == 0.0f) {
+            return *this * alpha;
+        }
+        // -alpha * e(0) is alpha times the identity.
+        return *this * create({{-alpha, 0}, {beta, pseudoscalar_mask()}});
+    }
+
+    // Largest part of grade 4 or more, relative to the norm of ~from * to, that
+    // interpolate() treats as rounding error outside 4D.
+    static constexpr float simple_tolerance = 1e-4f;
+
+    // Rotor interpolation from * exp(t * log(~from * to)) for normalized rotors.
+    // Only the even parts of ~from * to are formed and the logarithm is taken in
+    // closed form, so from(0) == from and from(1) == to. In 4D the relative rotor
+    // is a + B + p I with B * B = s + q I, and I commutes with it, so the power is
+    // taken over the numbers x + y I as Motor::log does with dual angles. In other
+    // dimensions the rotors must be simple: if ~from * to has a part of grade 4 or
+    // more beyond simple_tolerance of its norm, this throws std::domain_error.
+    static Multivector interpolate(const Multivector &from, const Multivector &to, float t) {
+        constexpr uint64_t I = pseudoscalar_mask();
+        float scalar = 0.0f, pseudoscalar = 0.0f;
+        Multivector bivector, higher;
+        for (const auto &a : from.blades()) {
+            for (const auto &b : to.blades()) {
+                uint64_t mask = a.mask ^ b.mask;
+                int grade = __builtin_popcountll(mask);
+                float c = relative_weight(a.mask, b.mask) * a.coefficient * b.coefficient;
+                if (grade == 0) {
+                    scalar += c;
+                } else if (grade == 2) {
+                    bivector.add_blade(c, mask);
+                } else if (grade == 4 && Signature::max_dimension() == 4) {
+                    pseudoscalar += c;
+                } else if (grade % 2 == 0) {
+                    higher.add_blade(c, mask);
+                }
+            }
+        }
+        bivector.compact();
+        higher.compact();
+        float total = scalar * scalar, excess = 0.0f;
+        for (const auto &b : bivector.blades()) {
+            total += b.coefficient * b.coefficient;
+        }
+        for (const auto &b : higher.blades()) {
+            excess += b.coefficient * b.coefficient;
+        }
+        if (excess > simple_tolerance * simple_tolerance * (total + excess)) {
+            throw std::domain_error("Rotors must be simple outside 4D");
+        }
+
+        float square = 0.0f, square_pseudoscalar = 0.0f;
+        for (const auto &b : bivector.blades()) {
+            square -= sign(b.mask, b.mask) * b.coefficient * b.coefficient;
+            if constexpr (Signature::max_dimension() == 4) {
+                for (const auto &d : bivector.blades()) {
+                    if ((b.mask ^ d.mask) == I) {
+                        square_pseudoscalar += sign(b.mask, d.mask) * b.coefficient * d.coefficient;
+                    }
+                }
+            }
+        }
+        auto [c, c_pseudoscalar, k, k_pseudoscalar] =
+            rotor_power(-scalar, pseudoscalar, square, square_pseudoscalar, t);
+        if (c_pseudoscalar == 0.0f && k_pseudoscalar == 0.0f) {
+            return from * c + (from * bivector) * k;
+        }
+        // -x * e(0) is x times the identity.
+        return from * create({{-c, 0}, {c_pseudoscalar, I}}) +
+               (from * bivector) * create({{-k, 0}, {k_pseudoscalar, I}});
+    }
+
+    static Multivector commutator(const Multivector &A, const Multivector &B) {
+        MULTIVECTOR_TRACE_SPAN(span, "commutator", A.size(), B.size());
+        Multivector result = A * B - B * A;
+        MULTIVECTOR_TRACE_RESULT(span, result.size());
+        return result;
+    }
+
+    static Multivector anticommutator(const Multivector &A, const Multivector &B) {
+        MULTIVECTOR_TRACE_SPAN(span, "anticommutator", A.size(), B.size());
+        Multivector result = A * B + B * A;
+        MULTIVECTOR_TRACE_RESULT(span, result.size());
+        return result;
+    }
+
+    template <class Strategy>
+    static Multivector product(const Multivector &A, const Multivector &B) {
+        Multivector result = Strategy::multiply(A, B);
+        result.auto_compact();
+        return result;
+    }
+
+    using GradeSet = std::bitset<Signature::max_dimension() + 1>;
+
+    static GradeSet grades(std::initializer_list<size_t> list) {
+        GradeSet set;
+        for (size_t g : list) {
+            set.set(g);
+        }
+        return set;
+    }
+
+    // The parts of A * B of the given grades. Pairs landing on any other grade
+    // are skipped before their sign is computed, and pairs of grade buckets
+    // that cannot reach a requested grade are skipped whole.
+    static Multivector product(const Multivector &A, const Multivector &B, const GradeSet &grades) {
+        return filtered_product(A, B, [&](size_t g, size_t h) { return reaches(g, h, grades); },
+                                [&](uint64_t a, uint64_t b) { return grades.test(grade(a ^ b)); });
+    }
+
+    // The blades `masks` of A * B.
+    static Multivector product(const Multivector &A, const Multivector &B, std::span<const uint64_t> masks) {
+        std::vector<uint64_t> sorted(masks.begin(), masks.end());
+        std::sort(sorted.begin(), sorted.end());
+        GradeSet grades;
+        for (uint64_t mask : sorted) {
+            grades.set(grade(mask));
+        }
+        return filtered_product(A, B, [&](size_t g, size_t h) { return reaches(g, h, grades); },
+                                [&](uint64_t a, uint64_t b) {
+                                    return std::binary_search(sorted.begin(), sorted.end(), a ^ b);
+                                });
+    }
+
+    // Outer product: the grade g + h part of the product of blades of grades g and h.
+    static Multivector wedge(const Multivector &A, const Multivector &B) {
+        return filtered_product(A, B, [](size_t g, size_t h) { return g + h <= Signature::max_dimension(); },
+                                [](uint64_t a, uint64_t b) { return (a & b) == 0; });
+    }
+
+    // Left contraction: the grade h - g part of the product of blades of grades g and h.
+    static Multivector left_contraction(const Multivector &A, const Multivector &B) {
+        return filtered_product(A, B, [](size_t g, size_t h) { return g <= h; },
+                                [](uint64_t a, uint64_t b) { return (a & ~b) == 0; });
+    }
+
+    // Sum of a whole batch, accumulated per blade with Accumulator and rounded once.
+    template <class Accumulator>
+    static Multivector sum(std::span<const Multivector> terms) {
+        Multivector result = AccumulatedProduct<Accumulator>::accumulate(terms);
+        result.auto_compact();
+        return result;
+    }
+
+    // Removes blades that are negligible under Compaction; returns how many.
+    size_t compact() {
+        float largest = 0.0f;
+        if (Compaction::mode == Compaction::Mode::Relative) {
+            for (const auto &b : blades()) {
+                largest = std::max(largest, std::fabs(b.coefficient));
+            }
+        }
+        const float threshold = Compaction::threshold(largest);
+        if (dense()) {
+            size_t pruned = 0;
+            for (float &c : m_dense) {
+                if (c != 0.0f && std::fabs(c) <= threshold) {
+                    c = 0.0f;
+                    pruned++;
+                }
+            }
+            if (pruned > 0) {
+                Compaction::record(pruned);
+            }
+            return pruned;
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < m_masks.size(); i++) {
+            if (std::fabs(m_coefficients[i]) > threshold) {
+                m_masks[kept] = m_masks[i];
+                m_coefficients[kept++] = m_coefficients[i];
+            }
+        }
+        size_t pruned = m_masks.size() - kept;
+        if (pruned > 0) {
+            m_masks.resize(kept);
+            m_coefficients.resize(kept);
+            Compaction::record(pruned);
+        }
+        return pruned;
+    }
+
+    size_t size() const {
+        if (dense()) {
+            return static_cast<size_t>(std::count_if(m_dense.begin(), m_dense.end(), [](float c) { return c != 0.0f; }));
+        }
+        return m_masks.size();
+    }
+
+    bool dense() const {
+        return !m_dense.empty();
+    }
+
+    // Fraction of the 2^N blades that are present.
+    double fill() const {
+        return static_cast<double>(size()) / std::ldexp(1.0, static_cast<int>(Signature::max_dimension()));
+    }
+
+    // Blades in storage order: insertion order when sparse, ascending masks when dense.
+    class BladeRange {
+    public:
+        class iterator {
+        public:
+            iterator(const Multivector *v, size_t i) : m_v(v), m_i(i) {
+                skip();
+            }
+
+            Blade operator*() const {
+                return m_v->dense() ? Blade{m_v->m_dense[m_i], m_i} : Blade{m_v->m_coefficients[m_i], m_v->m_masks[m_i]};
+            }
+
+            iterator &operator++() {
+                m_i++;
+                skip();
+                return *this;
+            }
+
+            bool operator==(const iterator &other) const {
+                return m_i == other.m_i;
+            }
+
+        private:
+            void skip() {
+                while (m_v->dense() && m_i < m_v->m_dense.size() && m_v->m_dense[m_i] == 0.0f) {
+                    m_i++;
+                }
+            }
+
+            const Multivector *m_v;
+            size_t m_i;
+        };
+
+        explicit BladeRange(const Multivector *v) : m_v(v) {}
+
+        iterator begin() const {
+            return {m_v, 0};
+        }
+
+        iterator end() const {
+            return {m_v, m_v->dense() ? m_v->m_dense.size() : m_v->m_masks.size()};
+        }
+
+    private:
+        const Multivector *m_v;
+    };
+
+    BladeRange blades() const {
+        return BladeRange(this);
+    }
+
+    // e(a) * e(b) == sign(a, b) * e(a ^ b)
+    static constexpr int32_t sign(uint64_t a, uint64_t b) {
+        uint64_t parity = blade_parity(a, b);
+
+        // Extra code necessary for handling different metrics
+        uint64_t repeated = a & b;
+        while (repeated) {
+            uint64_t i = __builtin_ctzll(repeated);
+            if (is_degenerate<Signature>(i)) {
+                return 0;
+            }
+            parity ^= Signature::value(i);
+            repeated &= (repeated - 1);
+        }
+        return 2 * parity - 1;
+    }
+
+    static constexpr uint64_t blade_parity(uint64_t a, uint64_t b) {
+        uint64_t parity = 0;
+        while (b) {
+            uint64_t lowest_set_bit = __builtin_ctzll(b);
+            uint64_t count_bits_below = __builtin_popcountll(a & ((1ULL << lowest_set_bit) - 1));
+            parity ^= count_bits_below & 1;
+            b &= b - 1;
+        }
+        return parity & 1;
+    }
+
+    friend Multivector operator*(float scalar, const Multivector& v) {
+        return v * scalar;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const Multivector &v) {
+        bool first = true;
+        for (const auto &b : v.blades()) {
+            os << (first ? "" : "\n") << b;
+            first = false;
+        }
+        return os;
+    }
+
+private:
+    friend class MatrixMultivector<Signature>;
+    friend class BinarySerializer<Signature>;
+    friend class TextFormat<Signature>;
+    friend class ProductPlan<Signature>;
+    friend class MultivectorBatch<Signature>;
+    friend class Even<Signature>;
+    template <class, size_t> friend class FixedMultivector;
+    friend class ConformalTransform;
+    friend class LorentzTransform;
+    template <class, uint64_t...>
+    friend class StaticMultivector;
+    friend struct BlockProduct;
+    friend struct ParallelProduct;
+    template <class>
+    friend struct AccumulatedProduct;
+
+    Multivector() = default;
+
+    static constexpr uint64_t pseudoscalar_mask() {
+        return Signature::max_dimension() == 64 ? ~0ULL : (1ULL << Signature::max_dimension()) - 1;
+    }
+
+    static constexpr int32_t reverse_sign(uint64_t mask) {
+        uint64_t grade = __builtin_popcountll(mask);
+        return (grade * (grade - 1) / 2) % 2 ? -1 : 1;
+    }
+
+    // Each involution negates the blades whose grade mod 4 is set in its pattern.
+    static constexpr unsigned reverse_grades = 0b1100;
+    static constexpr unsigned involute_grades = 0b1010;
+    static constexpr unsigned conjugate_grades = 0b0110;
+
+    static constexpr size_t dense_size =
+        Signature::max_dimension() <= Representation::max_dimension ? size_t(1) << Signature::max_dimension() : 1;
+
+    // Branch-free popcount; __builtin_popcountll is a library call without -mpopcnt and blocks vectorization.
+    static constexpr uint64_t grade(uint64_t mask) {
+        mask = mask - ((mask >> 1) & 0x5555555555555555ULL);
+        mask = (mask & 0x3333333333333333ULL) + ((mask >> 2) & 0x3333333333333333ULL);
+        mask = (mask + (mask >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (mask * 0x0101010101010101ULL) >> 56;
+    }
+
+    template <unsigned Grades>
+    static constexpr float involution_sign(uint64_t mask) {
+        return (Grades >> (grade(mask) & 3)) & 1 ? -1.0f : 1.0f;
+    }
+
+    template <unsigned Grades>
+    static constexpr std::array<float, dense_size> involution_signs() {
+        std::array<float, dense_size> signs{};
+        for (size_t mask = 0; mask < dense_size; mask++) {
+            signs[mask] = involution_sign<Grades>(mask);
+        }
+        return signs;
+    }
+
+    // sign(m, m) per mask, times the reverse sign of m if Reversed: the weights of
+    // the e(0) parts of A * B and A * ~A. Built on first use; at 16 dimensions
+    // the table is too large to evaluate at compile time.
+    template <bool Reversed>
+    static const std::vector<float> &square_signs() {
+        static const std::vector<float> signs = [] {
+            std::vector<float> table(dense_size);
+            for (size_t mask = 0; mask < dense_size; mask++) {
+                table[mask] = static_cast<float>(sign(mask, mask) * (Reversed ? reverse_sign(mask) : 1));
+            }
+            return table;
+        }();
+        return signs;
+    }
+
+    // Blades sorted by grade; grade g occupies [offsets[g], offsets[g + 1]).
+    struct GradeBuckets {
+        std::vector<Blade> blades;
+        std::array<size_t, Signature::max_dimension() + 2> offsets{};
+
+        explicit GradeBuckets(const Multivector &v) {
+            for (const auto &b : v.blades()) {
+                offsets[grade(b.mask) + 1]++;
+            }
+            for (size_t g = 1; g < offsets.size(); g++) {
+                offsets[g] += offsets[g - 1];
+            }
+            blades.resize(offsets.back());
+            std::array<size_t, Signature::max_dimension() + 2> next = offsets;
+            for (const auto &b : v.blades()) {
+                blades[next[grade(b.mask)]++] = b;
+            }
+        }
+    };
+
+    // Blades of grades g and h multiply to grades |g - h| to min(g + h, 2N - g - h) in steps of 2.
+    static bool reaches(size_t g, size_t h, const GradeSet &grades) {
+        const size_t n = Signature::max_dimension();
+        const size_t high = std::min(g + h, 2 * n - g - h);
+        for (size_t k = g > h ? g - h : h - g; k <= high; k += 2) {
+            if (grades.test(k)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // A * B restricted to the blade pairs (a, b) with keep_pair(a, b), visited
+    // only within grade buckets (g, h) with keep_buckets(g, h).
+    template <class BucketFilter, class PairFilter>
+    static Multivector filtered_product(const Multivector &A, const Multivector &B, BucketFilter keep_buckets,
+                                        PairFilter keep_pair) {
+        MULTIVECTOR_TRACE_SPAN(span, "filtered_product", A.size(), B.size());
+        const GradeBuckets left(A), right(B);
+        Multivector result;
+        for (size_t g = 0; g + 1 < left.offsets.size(); g++) {
+            for (size_t h = 0; h + 1 < right.offsets.size(); h++) {
+                if (left.offsets[g] == left.offsets[g + 1] || right.offsets[h] == right.offsets[h + 1] ||
+                    !keep_buckets(g, h)) {
+                    continue;
+                }
+                for (size_t i = left.offsets[g]; i < left.offsets[g + 1]; i++) {
+                    const Blade &a = left.blades[i];
+                    for (size_t j = right.offsets[h]; j < right.offsets[h + 1]; j++) {
+                        const Blade &b = right.blades[j];
+                        if (keep_pair(a.mask, b.mask)) {
+                            result.add_blade(a.coefficient * b.coefficient * sign(a.mask, b.mask), a.mask ^ b.mask);
+                        }
+                    }
+                }
+            }
+        }
+        result.auto_compact();
+        MULTIVECTOR_TRACE_RESULT(span, result.size());
+        return result;
+    }
+
+    // Indices of the sparse blades in ascending mask order.
+    std::vector<uint32_t> mask_order() const {
+        std::vector<uint32_t> order(m_masks.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = static_cast<uint32_t>(i);
+        }
+        std::sort(order.begin(), order.end(), [&](uint32_t i, uint32_t j) { return m_masks[i] < m_masks[j]; });
+        return order;
+    }
+
+    // A sign flip per blade, computed from the mask alone, so both loops vectorize.
+    template <unsigned Grades>
+    void apply_involution() {
+        if (dense()) {
+            if constexpr (dense_capable()) {
+                static constexpr std::array<float, dense_size> signs = involution_signs<Grades>();
+                float *c = m_dense.data();
+                for (size_t i = 0; i < dense_size; i++) {
+                    c[i] *= signs[i];
+                }
+            }
+            return;
+        }
+        const Mask *masks = m_masks.data();
+        float *c = m_coefficients.data();
+        for (size_t i = 0; i < m_masks.size(); i++) {
+            c[i] *= involution_sign<Grades>(masks[i]);
+        }
+    }
+
+    // Sign with which c_a * c_b lands on e(a ^ b) in A * ~B.
+    static constexpr float versor_weight(uint64_t a, uint64_t b) {
+        return static_cast<float>(sign(a, b) * reverse_sign(b));
+    }
+
+    // Sign with which c_a * c_b lands on e(a ^ b) in ~A * B.
+    static constexpr float relative_weight(uint64_t a, uint64_t b) {
+        return static_cast<float>(reverse_sign(a) * sign(a, b));
+    }
+
+    // Given R * ~R = scalar * e(0) + pseudoscalar * e(I), returns alpha, beta such that
+    // R * (-alpha * e(0) + beta * e(I)) is normalized. Since e(0) is minus the identity,
+    // this is (sigma + pi * I)^(-1/2) for sigma = -scalar, pi = pseudoscalar.
+    static std::pair<float, float> inverse_sqrt(float scalar, float pseudoscalar) {
+        double sigma = -scalar, pi = pseudoscalar;
+        if (sigma < 0.0) {
+            sigma = -sigma;
+            pi = -pi;
+        }
+        if (pi == 0.0) {
+            return {static_cast<float>(1.0 / std::sqrt(sigma)), 0.0f};
+        }
+        const uint64_t I = pseudoscalar_mask();
+        if (sign(I, I) == 0) {
+            // I * I == 0: dual number, (sigma + pi I)^(-1/2) = sigma^(-1/2) (1 - pi / (2 sigma) I).
+            double inverse = 1.0 / std::sqrt(sigma);
+            return {static_cast<float>(inverse), static_cast<float>(-pi * inverse / (2.0 * sigma))};
+        }
+        if (sign(I, I) > 0) {
+            // I * I == -1: complex square root.
+            std::complex<double> w = 1.0 / std::sqrt(std::complex<double>(sigma, pi));
+            return {static_cast<float>(w.real()), static_cast<float>(w.imag())};
+        }
+        // I * I == +1: split-complex square root through the idempotents (1 +- I) / 2.
+        double u = 1.0 / std::sqrt(sigma + pi), v = 1.0 / std::sqrt(std::fabs(sigma - pi));
+        return {static_cast<float>((u + v) / 2), static_cast<float>((u - v) / 2)};
+    }
+
+    // (a + B)^t == c + k * B in true scalars, for a bivector B with B * B == square.
+    static std::pair<float, float> rotor_power(float a, float square, float t) {
+        double n = std::sqrt(std::fabs(static_cast<double>(square)));
+        if (n == 0.0) {
+            // Null bivector: |a|^t * exp(t * B / a), with the same sign handling as boosts.
+            double scale = std::pow(std::fabs(static_cast<double>(a)), static_cast<double>(t));
+            return {static_cast<float>(scale), static_cast<float>(scale * t / a)};
+        }
+        double r, theta, c, s;
+        if (square < 0.0f) {
+            r = std::hypot(static_cast<double>(a), n);
+            theta = std::atan2(n, static_cast<double>(a));
+            c = std::cos(t * theta);
+            s = std::sin(t * theta);
+        } else {
+            // Boosts have no logarithm for a < 0; interpolate to the equivalent -to instead.
+            double m = std::fabs(static_cast<double>(a));
+            r = std::sqrt(std::fabs(m * m - n * n));
+            theta = std::atanh(std::min(n / m, 1.0 - 1e-15)) * (a < 0.0f ? -1.0 : 1.0);
+            c = std::cosh(t * theta);
+            s = std::sinh(t * theta);
+        }
+        double scale = std::pow(r, static_cast<double>(t));
+        return {static_cast<float>(scale * c), static_cast<float>(scale * s / n)};
+    }
+
+    // (a + p I + B)^t == (c0 + c1 I) + (k0 + k1 I) * B in true scalars, for a
+    // bivector B with B * B == s + q I; returns {c0, c1, k0, k1}. Only used in 4D,
+    // where I commutes with even elements, so this is rotor_power over the numbers
+    // x + y I: complex for I * I == -1, a pair of real powers through the
+    // idempotents (1 +- I) / 2 for I * I == +1, and f(x) + y f'(x) I for I * I == 0.
+    // Boosts of a dual algebra use the a > 0 branch of rotor_power.
+    static std::array<float, 4> rotor_power(float a, float p, float s, float q, float t) {
+        if (p == 0.0f && q == 0.0f) {
+            auto [c, k] = rotor_power(a, s, t);
+            return {c, 0.0f, k, 0.0f};
+        }
+        const uint64_t I = pseudoscalar_mask();
+        if (sign(I, I) > 0) {
+            auto [c, k] = complex_rotor_power({a, p}, {s, q}, t);
+            return {static_cast<float>(c.real()), static_cast<float>(c.imag()), static_cast<float>(k.real()),
+                    static_cast<float>(k.imag())};
+        }
+        if (sign(I, I) < 0) {
+            auto [c_plus, k_plus] = rotor_power(a + p, s + q, t);
+            auto [c_minus, k_minus] = rotor_power(a - p, s - q, t);
+            return {(c_plus + c_minus) / 2, (c_plus - c_minus) / 2, (k_plus + k_minus) / 2, (k_plus - k_minus) / 2};
+        }
+        auto [c, k] = rotor_power(a, s, t);
+        if (s == 0.0f) {
+            // A null bivector has no dual part to differentiate along.
+            return {c, 0.0f, k, 0.0f};
+        }
+        // Dual numbers: the closed form of rotor_power differentiated along (p, q).
+        const bool hyperbolic = s > 0.0f;
+        const double n = std::sqrt(std::fabs(static_cast<double>(s)));
+        const double dn = (hyperbolic ? q : -q) / (2.0 * n);
+        const double r2 = hyperbolic ? double(a) * a - n * n : double(a) * a + n * n;
+        const double dr2 = 2.0 * (hyperbolic ? a * p - n * dn : a * p + n * dn);
+        const double theta = hyperbolic ? std::atanh(n / a) : std::atan2(n, static_cast<double>(a));
+        const double dtheta = (a * dn - n * p) / r2;
+        const double scale = std::pow(std::fabs(r2), t / 2.0), dscale = scale * t * dr2 / (2.0 * r2);
+        const double even = hyperbolic ? std::cosh(t * theta) : std::cos(t * theta);
+        const double odd = hyperbolic ? std::sinh(t * theta) : std::sin(t * theta);
+        const double deven = t * dtheta * (hyperbolic ? odd : -odd), dodd = t * dtheta * even;
+        const double dc = dscale * even + scale * deven;
+        const double dk = ((dscale * odd + scale * dodd) * n - scale * odd * dn) / (n * n);
+        return {c, static_cast<float>(dc), k, static_cast<float>(dk)};
+    }
+
+    // rotor_power over complex a and square: (a + B)^t = r^t (cos(t theta) + sin(t theta) / n * B)
+    // with n = sqrt(-square), r = sqrt(a^2 + n^2) and cos(theta) + i sin(theta) = (a + i n) / r.
+    // Both parts are even in n, so the branch of the square root does not matter.
+    static std::pair<std::complex<double>, std::complex<double>> complex_rotor_power(std::complex<double> a,
+                                                                                     std::complex<double> square,
+                                                                                     double t) {
+        const std::complex<double> i(0.0, 1.0);
+        if (square == 0.0) {
+            const std::complex<double> scale = std::pow(a, t);
+            return {scale, scale * t / a};
+        }
+        const std::complex<double> n = std::sqrt(-square), r = std::sqrt(a * a - square);
+        const std::complex<double> theta = -i * std::log((a + i * n) / r), scale = std::pow(r, t);
+        return {scale * std::cos(t * theta), scale * std::sin(t * theta) / n};
+    }
+
+    // Runs after every operation: compaction, then the representation switch.
+    void auto_compact() {
+        if (Compaction::automatic) {
+            compact();
+        }
+        if (Representation::automatic && dense_capable() && dense() &&
+            size() < Representation::sparse_fill * m_dense.size()) {
+            make_sparse();
+        }
+    }
+
+    void add_blade(float coeff, uint64_t mask) {
+        // Checked before the narrowing cast below, which would alias an existing blade.
+        if (mask > pseudoscalar_mask()) {
+            throw std::out_of_range("Blade outside of signature bounds");
+        }
+        if (coeff == 0.0f) {
+            return;
+        }
+        if (dense()) {
+            m_dense[mask] += coeff;
+            return;
+        }
+        const Mask key = static_cast<Mask>(mask);
+        const Mask *masks = m_masks.data();
+        for (size_t i = 0; i < m_masks.size(); i++) {
+            if (masks[i] == key) {
+                m_coefficients[i] += coeff;
+                return;
+            }
+        }
+        push_blade(coeff, mask);
+        if (Representation::automatic && dense_capable() && m_masks.size() > dense_limit()) {
+            make_dense();
+        }
+    }
+
+    // Appends without looking for an existing blade; mask must not be present yet.
+    void push_blade(float coeff, uint64_t mask) {
+        assert(mask <= pseudoscalar_mask() && "Blade outside of signature bounds");
+        m_masks.push_back(static_cast<Mask>(mask));
+        m_coefficients.push_back(coeff);
+    }
+
+    void reserve(size_t count) {
+        m_masks.reserve(count);
+        m_coefficients.reserve(count);
+    }
+
+    std::vector<Blade> blade_vector() const {
+        std::vector<Blade> result;
+        result.reserve(size());
+        for (const auto &b : blades()) {
+            result.push_back(b);
+        }
+        return result;
+    }
+
+    static constexpr bool dense_capable() {
+        return Signature::max_dimension() <= Representation::max_dimension;
+    }
+
+    static size_t dense_limit() {
+        return static_cast<size_t>(Representation::dense_fill * static_cast<float>(dense_size));
+    }
+
+    Multivector empty_like() const {
+        Multivector result;
+        if (dense()) {
+            result.make_dense();
+        }
+        return result;
+    }
+
+    void make_dense() {
+        if constexpr (dense_capable()) {
+            m_dense.assign(dense_size, 0.0f);
+            for (size_t i = 0; i < m_masks.size(); i++) {
+                m_dense[m_masks[i]] += m_coefficients[i];
+            }
+            std::vector<Mask>().swap(m_masks);
+            std::vector<float>().swap(m_coefficients);
+        }
+    }
+
+    void make_sparse() {
+        std::vector<float> dense;
+        dense.swap(m_dense);
+        m_masks.clear();
+        m_coefficients.clear();
+        for (size_t mask = 0; mask < dense.size(); mask++) {
+            if (dense[mask] != 0.0f) {
+                push_blade(dense[mask], mask);
+            }
+        }
+    }
+
+    // out += a * b over dense coefficient arrays, visiting only the nonzero blades of b.
+    static void multiply_dense(const float *a, const float *b, float *out) {
+        const size_t size = dense_size;
+        std::vector<Mask> present;
+        for (size_t j = 0; j < size; j++) {
+            if (b[j] != 0.0f) {
+                present.push_back(static_cast<Mask>(j));
+            }
+        }
+        for (size_t i = 0; i < size; i++) {
+            if (a[i] == 0.0f) {
+                continue;
+            }
+            if constexpr (Signature::max_dimension() <= Representation::sign_table_dimension) {
+                const int8_t *row = dense_signs().data() + i * size;
+                for (const Mask j : present) {
+                    out[i ^ j] += a[i] * b[j] * row[j];
+                }
+            } else {
+                for (const Mask j : present) {
+                    out[i ^ j] += a[i] * b[j] * sign(i, j);
+                }
+            }
+        }
+    }
+
+    // sign(i, j) at [i * dense_size + j].
+    static const std::vector<int8_t> &dense_signs() {
+        static const std::vector<int8_t> signs = [] {
+            std::vector<int8_t> table(dense_size * dense_size);
+            for (size_t i = 0; i < dense_size; i++) {
+                for (size_t j = 0; j < dense_size; j++) {
+                    table[i * dense_size + j] = static_cast<int8_t>(sign(i, j));
+                }
+            }
+            return table;
+        }();
+        return signs;
+    }
+
+private:
+    using Mask = BladeMask<Signature::max_dimension()>;
+
+    // Sparse blades as parallel arrays, so masks pack at their natural width; empty while dense.
+    std::vector<Mask> m_masks;
+    std::vector<float> m_coefficients;
+    // One coefficient per mask; empty while sparse. See Representation.
+    std::vector<float> m_dense;
+};
+
+using CliffordMultivector = Multivector<EuclideanSignature<64>>;
+using EuclideanMultivector = Multivector<EuclideanSignature<4>>;
+using SpacetimeMultivector = Multivector<MinkowskiSignature>;
+using ProjectiveMultivector = Multivector<ProjectiveSignature>;
+using ConformalMultivector = Multivector<ConformalSignature>;
+
+/**
+ * Multivector with inline storage for up to Capacity blades.
+ *
+ * Mirrors the Multivector API with constexpr create, basis_vector, sums,
+ * products and reverse, so constants such as basis products and
+ * pseudoscalars can be evaluated at compile time and folded into the binary.
+ * Blades keep the insertion order of Multivector and cancelled blades are
+ * removed exactly, as with the default Compaction policy. Exceeding the
+ * capacity is a compile error in constant evaluation and an assertion at
+ * runtime.
+ */
+template <class Signature, size_t Capacity = 16>
+class FixedMultivector {
+public:
+    struct Blade {
+        float coefficient;
+        uint64_t mask;
+    };
+
+    static constexpr FixedMultivector create(const std::initializer_list<Blade> &blades) {
+        FixedMultivector v;
+        for (const auto &b : blades) {
+            v.add_blade(b.coefficient, b.mask);
+        }
+        return v;
+    }
+
+    static constexpr FixedMultivector basis_vector(uint64_t i) {
+        assert(i < Signature::max_dimension() && "Basis vector index exceed maximum value");
+        FixedMultivector v;
+        v.add_blade(1.0f, 1ULL << i);
+        return v;
+    }
+
+    constexpr FixedMultivector operator+(const FixedMultivector &other) const {
+        FixedMultivector result = *this;
+        for (size_t i = 0; i < other.m_size; i++) {
+            result.add_blade(other.m_blades[i].coefficient, other.m_blades[i].mask);
+        }
+        result.compact();
+        return result;
+    }
+
+    constexpr FixedMultivector operator-(const FixedMultivector &other) const {
+        FixedMultivector result = *this;
+        for (size_t i = 0; i < other.m_size; i++) {
+            result.add_blade(-other.m_blades[i].coefficient, other.m_blades[i].mask);
+        }
+        result.compact();
+        return result;
+    }
+
+    constexpr FixedMultivector operator*(float scalar) const {
+        FixedMultivector result;
+        for (size_t i = 0; i < m_size; i++) {
+            result.add_blade(scalar * m_blades[i].coefficient, m_blades[i].mask);
+        }
+        return result;
+    }
+
+    constexpr FixedMultivector operator*(const FixedMultivector &other) const {
+        FixedMultivector result;
+        for (size_t i = 0; i < m_size; i++) {
+            for (size_t j = 0; j < other.m_size; j++) {
+                const Blade &a = m_blades[i], &b = other.m_blades[j];
+                int32_t s = Multivector<Signature>::sign(a.mask, b.mask);
+                result.add_blade(a.coefficient * b.coefficient * s, a.mask ^ b.mask);
+            }
+        }
+        result.compact();
+        return result;
+    }
+
+    constexpr FixedMultivector reverse() const {
+        FixedMultivector result;
+        for (size_t i = 0; i < m_size; i++) {
+            uint64_t grade = __builtin_popcountll(m_blades[i].mask);
+            uint64_t parity = (grade * (grade - 1) / 2) % 2;
+            int32_t sign = 1 - 2 * parity;
+            result.add_blade(m_blades[i].coefficient * sign, m_blades[i].mask);
+        }
+        return result;
+    }
+
+    constexpr FixedMultivector operator~() const {
+        return reverse();
+    }
+
+    constexpr size_t size() const {
+        return m_size;
+    }
+
+    Multivector<Signature> to_multivector() const {
+        Multivector<Signature> result;
+        for (size_t i = 0; i < m_size; i++) {
+            result.add_blade(m_blades[i].coefficient, m_blades[i].mask);
+        }
+        return result;
+    }
+
+    friend constexpr FixedMultivector operator*(float scalar, const FixedMultivector &v) {
+        return v * scalar;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const FixedMultivector &v) {
+        for (size_t i = 0; i < v.m_size; i++) {
+            os << v.m_blades[i].coefficient << " * e(" << v.m_blades[i].mask << ")" << (i < v.m_size - 1 ? "\n" : "");
+        }
+        return os;
+    }
+
+private:
+    constexpr void add_blade(float coeff, uint64_t mask) {
+        if (coeff == 0.0f) {
+            return;
+        }
+        for (size_t i = 0; i < m_size; i++) {
+            if (m_blades[i].mask == mask) {
+                m_blades[i].coefficient += coeff;
+                return;
+            }
+        }
+        assert(m_size < Capacity && "FixedMultivector capacity exceeded");
+        m_blades[m_size++] = {coeff, mask};
+    }
+
+    constexpr void compact() {
+        size_t kept = 0;
+        for (size_t i = 0; i < m_size; i++) {
+            if (m_blades[i].coefficient != 0.0f) {
+                m_blades[kept++] = m_blades[i];
+            }
+        }
+        m_size = kept;
+    }
+
+    std::array<Blade, Capacity> m_blades{};
+    size_t m_size = 0;
+};
+
+using FixedSpacetimeMultivector = FixedMultivector<MinkowskiSignature>;
+
+/**
+ * Dense matrix representation of a multivector.
+ *
+ * Every blade e(mask) maps to a monomial complex matrix built from Kronecker
+ * products of Pauli matrices (one qubit per pair of basis vectors), so that
+ * the representation reproduces exactly the sign convention of
+ * Multivector::operator*. A product then becomes a blocked matrix product of
+ * order 2^ceil(N/2) instead of 4^N pairwise blade products, which pays off
+ * for dense multivectors in 8-12 dimensions. Convert once with from(), chain
+ * as many products as needed, and convert back with to_multivector().
+ */
+template <class Signature>
+class MatrixMultivector {
+public:
+    static constexpr size_t dimension = Signature::max_dimension();
+    static constexpr size_t order = size_t(1) << ((dimension + 1) / 2);
+
+    static_assert(dimension <= 16, "Matrix representation is limited to 16 dimensions");
+    static_assert(!has_degenerate_metric<Signature>(), "Matrix representation needs a non-degenerate metric");
+
+    static MatrixMultivector from(const Multivector<Signature> &v) {
+        const auto &table = blade_table();
+        MatrixMultivector m;
+        for (const auto &b : v.blades()) {
+            assert(b.mask < (1ULL << dimension) && "Blade outside of signature bounds");
+            const Entry *row = &table[b.mask * order];
+            for (size_t r = 0; r < order; r++) {
+                float *real = &m.m_real[r * order + row[r].column];
+                float *imag = &m.m_imag[r * order + row[r].column];
+                switch (row[r].phase) {
+                    case 0: *real += b.coefficient; break;
+                    case 1: *imag += b.coefficient; break;
+                    case 2: *real -= b.coefficient; break;
+                    case 3: *imag -= b.coefficient; break;
+                }
+            }
+        }
+        return m;
+    }
+
+    Multivector<Signature> to_multivector() const {
+        const auto &table = blade_table();
+        float largest = 0.0f;
+        for (size_t i = 0; i < order * order; i++) {
+            largest = std::max({largest, std::fabs(m_real[i]), std::fabs(m_imag[i])});
+        }
+        // Entries of a product accumulate `order` roundings each, so anything
+        // below that level is what is left of an exact cancellation.
+        const float tolerance = std::numeric_limits<float>::epsilon() * order * largest;
+
+        Multivector<Signature> result;
+        for (uint64_t mask = 0; mask < (1ULL << dimension); mask++) {
+            const Entry *row = &table[mask * order];
+            float sum = 0.0f;
+            for (size_t r = 0; r < order; r++) {
+                size_t i = r * order + row[r].column;
+                switch (row[r].phase) {
+                    case 0: sum += m_real[i]; break;
+                    case 1: sum += m_imag[i]; break;
+                    case 2: sum -= m_real[i]; break;
+                    case 3: sum -= m_imag[i]; break;
+                }
+            }
+            float coeff = sum / order;
+            if (std::fabs(coeff) > tolerance) {
+                result.push_blade(coeff, mask);
+            }
+        }
+        return result;
+    }
+
+    MatrixMultivector operator+(const MatrixMultivector &other) const {
+        MatrixMultivector result = *this;
+        for (size_t i = 0; i < order * order; i++) {
+            result.m_real[i] += other.m_real[i];
+            result.m_imag[i] += other.m_imag[i];
+        }
+        return result;
+    }
+
+    MatrixMultivector operator-(const MatrixMultivector &other) const {
+        MatrixMultivector result = *this;
+        for (size_t i = 0; i < order * order; i++) {
+            result.m_real[i] -= other.m_real[i];
+            result.m_imag[i] -= other.m_imag[i];
+        }
+        return result;
+    }
+
+    MatrixMultivector operator*(float scalar) const {
+        MatrixMultivector result = *this;
+        for (size_t i = 0; i < order * order; i++) {
+            result.m_real[i] *= scalar;
+            result.m_imag[i] *= scalar;
+        }
+        return result;
+    }
+
+    MatrixMultivector operator*(const MatrixMultivector &other) const {
+        constexpr size_t block = order < 64 ? order : 64;
+        MatrixMultivector result;
+        for (size_t kk = 0; kk < order; kk += block) {
+            for (size_t jj = 0; jj < order; jj += block) {
+                for (size_t i = 0; i < order; i++) {
+                    float *c_real = &result.m_real[i * order];
+                    float *c_imag = &result.m_imag[i * order];
+                    for (size_t k = kk; k < kk + block; k++) {
+                        const float a_real = m_real[i * order + k];
+                        const float a_imag = m_imag[i * order + k];
+                        const float *b_real = &other.m_real[k * order];
+                        const float *b_imag = &other.m_imag[k * order];
+                        for (size_t j = jj; j < jj + block; j++) {
+                            c_real[j] += a_real * b_real[j] - a_imag * b_imag[j];
+                            c_imag[j] += a_real * b_imag[j] + a_imag * b_real[j];
+                        }
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    friend MatrixMultivector operator*(float scalar, const MatrixMultivector &m) {
+        return m * scalar;
+    }
+
+private:
+    // Row r of a blade matrix holds a single nonzero entry, i^phase, at `column`.
+    struct Entry {
+        uint32_t column;
+        uint8_t phase;
+    };
+
+    MatrixMultivector() : m_real(order * order, 0.0f), m_imag(order * order, 0.0f) {}
+
+    static const std::vector<Entry> &blade_table() {
+        static const std::vector<Entry> table = build_blade_table();
+        return table;
+    }
+
+    static std::vector<Entry> build_blade_table() {
+        using V = Multivector<Signature>;
+        std::vector<Entry> table((1ULL << dimension) * order);
+
+        // The scalar blade e(0) squares to -e(0), so it maps to minus the identity.
+        for (size_t r = 0; r < order; r++) {
+            table[r] = {static_cast<uint32_t>(r), 2};
+        }
+
+        for (uint64_t mask = 1; mask < (1ULL << dimension); mask++) {
+            Entry *row = &table[mask * order];
+            uint64_t low = mask & (~mask + 1);
+            uint64_t rest = mask ^ low;
+
+            if (rest == 0) {
+                // Jordan-Wigner generator: Z on the qubits below, X or Y on its own.
+                size_t k = __builtin_ctzll(mask);
+                size_t qubit = k / 2;
+                // e_k * e_k = sign * e(0) must map to -sign times the identity.
+                uint8_t twist = V::sign(mask, mask) > 0 ? 1 : 0;
+                for (size_t r = 0; r < order; r++) {
+                    uint8_t phase = 2 * __builtin_popcountll(r & ((1ULL << qubit) - 1));
+                    if (k % 2 == 1) {
+                        phase += (r >> qubit) & 1 ? 1 : 3;
+                    }
+                    row[r] = {static_cast<uint32_t>(r ^ (1ULL << qubit)),
+                              static_cast<uint8_t>((phase + twist) % 4)};
+                }
+                continue;
+            }
+
+            // e(mask) = sign(low, rest) * e(low) * e(rest)
+            const Entry *left = &table[low * order];
+            const Entry *right = &table[rest * order];
+            uint8_t twist = V::sign(low, rest) > 0 ? 0 : 2;
+            for (size_t r = 0; r < order; r++) {
+                const Entry &l = left[r];
+                const Entry &k = right[l.column];
+                row[r] = {k.column, static_cast<uint8_t>((l.phase + k.phase + twist) % 4)};
+            }
+        }
+        return table;
+    }
+
+    // Planar storage keeps the inner product loop free of complex arithmetic calls.
+    std::vector<float> m_real;
+    std::vector<float> m_imag;
+};
+
+/**
+ * Product strategies for Multivector::product<Strategy>(A, B).
+ *
+ * PairwiseProduct is the reference blade-by-blade loop of operator*.
+ * MatrixProduct goes through MatrixMultivector for a single product.
+ */
+struct PairwiseProduct {
+    template <class Signature>
+    static Multivector<Signature> multiply(const Multivector<Signature> &A, const Multivector<Signature> &B) {
+        return A * B;
+    }
+};
+
+struct MatrixProduct {
+    template <class Signature>
+    static Multivector<Signature> multiply(const Multivector<Signature> &A, const Multivector<Signature> &B) {
+        using M = MatrixMultivector<Signature>;
+        return (M::from(A) * M::from(B)).to_multivector();
+    }
+};
+
+/**
+ * Divide-and-conquer geometric product for dense multivectors.
+ *
+ * Two anticommuting generators a, b split the algebra into the tensor product
+ * of their span {1, a, b, ab} with the subalgebra generated by g_i * a * b,
+ * which commutes with both. Unless a and b both square to -1 their span is
+ * M2(R), e.g. Cl(p+1,q+1) = M2(Cl(p,q)), so a product becomes a 2x2 block
+ * matrix product: 8 half-size products instead of 16. Otherwise the span is
+ * the quaternions and the 16 products are kept. Below `cutoff` generators the
+ * recursion falls back to a table-driven kernel.
+ *
+ * The recursion works in the ascending blade basis where the scalar blade is
+ * the identity; orientation[mask] converts from the basis of operator*.
+ */
+struct BlockProduct {
+    static constexpr size_t cutoff = 4;
+
+    template <class Signature>
+    static Multivector<Signature> multiply(const Multivector<Signature> &A, const Multivector<Signature> &B) {
+        using V = Multivector<Signature>;
+        constexpr size_t dimension = Signature::max_dimension();
+        static_assert(dimension <= 20, "Block product is limited to 20 dimensions");
+        static_assert(!has_degenerate_metric<Signature>(), "Block product needs a non-degenerate metric");
+        static const Plan plan = build_plan<Signature>();
+
+        const size_t size = size_t(1) << dimension;
+        std::vector<float> a(size, 0.0f), b(size, 0.0f), c(size, 0.0f);
+        for (const auto &blade : A.blades()) {
+            a[blade.mask] += plan.orientation[blade.mask] * blade.coefficient;
+        }
+        for (const auto &blade : B.blades()) {
+            b[blade.mask] += plan.orientation[blade.mask] * blade.coefficient;
+        }
+
+        multiply_into(plan, 0, a.data(), b.data(), c.data());
+
+        float largest = 0.0f;
+        for (float x : c) {
+            largest = std::max(largest, std::fabs(x));
+        }
+        // Block conversions round twice per level; treat that residue as an exact cancellation.
+        const float tolerance = std::numeric_limits<float>::epsilon() * 2 * plan.levels.size() * largest;
+
+        V result;
+        for (uint64_t mask = 0; mask < size; mask++) {
+            if (std::fabs(c[mask]) > tolerance) {
+                result.push_blade(plan.orientation[mask] * c[mask], mask);
+            }
+        }
+        return result;
+    }
+
+private:
+    enum class Split { Table, Matrix, Quaternion };
+
+    // A signed basis blade of the ascending basis.
+    struct Term {
+        uint64_t mask;
+        int32_t sign;
+    };
+
+    struct Level {
+        Split split;
+        size_t dimension;
+        // Table: sign of g_i * g_j at [i * 2^dimension + j].
+        std::vector<int8_t> table;
+        // Matrix and Quaternion: g_mask = sign * g'_sub * P_part.
+        std::vector<uint32_t> sub;
+        std::vector<uint8_t> part;
+        std::vector<int8_t> sign;
+        // Matrix: 2x2 image of P_part. Quaternion: P_t * P_u = pair[t][u] * P_{t ^ u}.
+        std::array<std::array<int8_t, 4>, 4> rep;
+        std::array<std::array<int8_t, 4>, 4> pair;
+    };
+
+    struct Plan {
+        std::vector<float> orientation;
+        std::vector<Level> levels;
+    };
+
+    template <class Signature>
+    static Plan build_plan() {
+        using V = Multivector<Signature>;
+        constexpr size_t dimension = Signature::max_dimension();
+
+        // e(mask) = orientation[mask] * g_mask, with e(0) = -1.
+        Plan plan;
+        plan.orientation.assign(size_t(1) << dimension, 1.0f);
+        plan.orientation[0] = -1.0f;
+        for (uint64_t mask = 1; mask < (1ULL << dimension); mask++) {
+            uint64_t low = mask & (~mask + 1);
+            if (mask != low) {
+                plan.orientation[mask] = V::sign(low, mask ^ low) * plan.orientation[mask ^ low];
+            }
+        }
+
+        std::vector<int32_t> squares;
+        for (size_t i = 0; i < dimension; i++) {
+            squares.push_back(-V::sign(1ULL << i, 1ULL << i));
+        }
+        while (true) {
+            plan.levels.push_back(build_level(squares));
+            if (plan.levels.back().split == Split::Table) {
+                break;
+            }
+            squares = reduced_squares(squares);
+        }
+        return plan;
+    }
+
+    static int32_t standard_sign(uint64_t a, uint64_t b, const std::vector<int32_t> &squares) {
+        uint64_t swaps = 0;
+        for (uint64_t rest = b; rest; rest &= rest - 1) {
+            swaps += __builtin_popcountll(a & ~((2ULL << __builtin_ctzll(rest)) - 1));
+        }
+        int32_t s = swaps % 2 ? -1 : 1;
+        for (uint64_t repeated = a & b; repeated; repeated &= repeated - 1) {
+            s *= squares[__builtin_ctzll(repeated)];
+        }
+        return s;
+    }
+
+    static Term multiply_terms(Term x, Term y, const std::vector<int32_t> &squares) {
+        return {x.mask ^ y.mask, x.sign * y.sign * standard_sign(x.mask, y.mask, squares)};
+    }
+
+    static std::pair<size_t, size_t> split_pair(const std::vector<int32_t> &squares) {
+        std::vector<size_t> positive, negative;
+        for (size_t i = 0; i < squares.size(); i++) {
+            (squares[i] > 0 ? positive : negative).push_back(i);
+        }
+        if (!positive.empty() && !negative.empty()) {
+            return std::minmax(positive.back(), negative.back());
+        }
+        const auto &same = positive.size() >= 2 ? positive : negative;
+        return {same[same.size() - 2], same.back()};
+    }
+
+    static std::vector<int32_t> reduced_squares(const std::vector<int32_t> &squares) {
+        auto [x, y] = split_pair(squares);
+        std::vector<int32_t> reduced;
+        for (size_t i = 0; i < squares.size(); i++) {
+            if (i != x && i != y) {
+                reduced.push_back(-squares[i] * squares[x] * squares[y]);
+            }
+        }
+        return reduced;
+    }
+
+    static Level build_level(const std::vector<int32_t> &squares) {
+        Level level{};
+        level.dimension = squares.size();
+        const size_t size = size_t(1) << level.dimension;
+
+        if (level.dimension <= cutoff) {
+            level.split = Split::Table;
+            level.table.resize(size * size);
+            for (uint64_t i = 0; i < size; i++) {
+                for (uint64_t j = 0; j < size; j++) {
+                    level.table[i * size + j] = standard_sign(i, j, squares);
+                }
+            }
+            return level;
+        }
+
+        auto [x, y] = split_pair(squares);
+        const uint64_t a = 1ULL << x, b = 1ULL << y;
+        level.split = squares[x] < 0 && squares[y] < 0 ? Split::Quaternion : Split::Matrix;
+
+        // P = {1, a, b, ab} and g'_k = g_k * a * b for the remaining generators.
+        const std::array<Term, 4> pair_terms = {Term{0, 1}, Term{a, 1}, Term{b, 1}, Term{a | b, 1}};
+        std::vector<Term> generators;
+        for (size_t i = 0; i < squares.size(); i++) {
+            if (i != x && i != y) {
+                generators.push_back(multiply_terms({1ULL << i, 1}, pair_terms[3], squares));
+            }
+        }
+
+        const size_t half = size / 4;
+        std::vector<Term> sub_terms(half, Term{0, 1});
+        for (uint64_t s = 1; s < half; s++) {
+            uint64_t high = 63 - __builtin_clzll(s);
+            sub_terms[s] = multiply_terms(sub_terms[s ^ (1ULL << high)], generators[high], squares);
+        }
+
+        level.sub.resize(size);
+        level.part.resize(size);
+        level.sign.resize(size);
+        for (uint64_t s = 0; s < half; s++) {
+            for (uint8_t t = 0; t < 4; t++) {
+                Term term = multiply_terms(sub_terms[s], pair_terms[t], squares);
+                level.sub[term.mask] = static_cast<uint32_t>(s);
+                level.part[term.mask] = t;
+                level.sign[term.mask] = static_cast<int8_t>(term.sign);
+            }
+        }
+
+        const std::vector<int32_t> pair_squares = {squares[x], squares[y]};
+        for (uint8_t t = 0; t < 4; t++) {
+            for (uint8_t u = 0; u < 4; u++) {
+                level.pair[t][u] = static_cast<int8_t>(standard_sign(t, u, pair_squares));
+            }
+        }
+
+        if (level.split == Split::Matrix) {
+            // Anticommuting 2x2 images, row-major: X = [[0,1],[1,0]], Z = [[1,0],[0,-1]], J = [[0,-1],[1,0]].
+            using M = std::array<int8_t, 4>;
+            const M X = {0, 1, 1, 0}, Z = {1, 0, 0, -1}, J = {0, -1, 1, 0};
+            M ra = squares[x] > 0 ? X : J;
+            M rb = squares[x] < 0 ? X : (squares[y] > 0 ? Z : J);
+            level.rep[0] = {1, 0, 0, 1};
+            level.rep[1] = ra;
+            level.rep[2] = rb;
+            level.rep[3] = {static_cast<int8_t>(ra[0] * rb[0] + ra[1] * rb[2]),
+                            static_cast<int8_t>(ra[0] * rb[1] + ra[1] * rb[3]),
+                            static_cast<int8_t>(ra[2] * rb[0] + ra[3] * rb[2]),
+                            static_cast<int8_t>(ra[2] * rb[1] + ra[3] * rb[3])};
+        }
+        return level;
+    }
+
+    // c += a * b in the ascending basis of plan.levels[depth].
+    static void multiply_into(const Plan &plan, size_t depth, const float *a, const float *b, float *c) {
+        const Level &level = plan.levels[depth];
+        const size_t size = size_t(1) << level.dimension;
+
+        if (level.split == Split::Table) {
+            for (size_t i = 0; i < size; i++) {
+                if (a[i] == 0.0f) {
+                    continue;
+                }
+                const int8_t *signs = &level.table[i * size];
+                for (size_t j = 0; j < size; j++) {
+                    c[i ^ j] += signs[j] * a[i] * b[j];
+                }
+            }
+            return;
+        }
+
+        const size_t half = size / 4;
+        std::vector<float> parts(3 * 4 * half, 0.0f);
+        float *x = &parts[0], *y = &parts[4 * half], *z = &parts[8 * half];
+        for (size_t mask = 0; mask < size; mask++) {
+            x[level.part[mask] * half + level.sub[mask]] = level.sign[mask] * a[mask];
+            y[level.part[mask] * half + level.sub[mask]] = level.sign[mask] * b[mask];
+        }
+
+        if (level.split == Split::Quaternion) {
+            std::vector<float> negated(4 * half);
+            for (size_t i = 0; i < 4 * half; i++) {
+                negated[i] = -x[i];
+            }
+            for (size_t t = 0; t < 4; t++) {
+                for (size_t u = 0; u < 4; u++) {
+                    const float *left = level.pair[t][u] > 0 ? &x[t * half] : &negated[t * half];
+                    multiply_into(plan, depth + 1, left, &y[u * half], &z[(t ^ u) * half]);
+                }
+            }
+        } else {
+            // Block entry (r, k) of an operand is sum_t rep[t][r][k] * part t.
+            std::vector<float> blocks(3 * 4 * half, 0.0f);
+            float *bx = &blocks[0], *by = &blocks[4 * half], *bz = &blocks[8 * half];
+            for (size_t t = 0; t < 4; t++) {
+                for (size_t e = 0; e < 4; e++) {
+                    if (level.rep[t][e] == 0) {
+                        continue;
+                    }
+                    for (size_t s = 0; s < half; s++) {
+                        bx[e * half + s] += level.rep[t][e] * x[t * half + s];
+                        by[e * half + s] += level.rep[t][e] * y[t * half + s];
+                    }
+                }
+            }
+            for (size_t r = 0; r < 2; r++) {
+                for (size_t col = 0; col < 2; col++) {
+                    for (size_t k = 0; k < 2; k++) {
+                        multiply_into(plan, depth + 1, &bx[(2 * r + k) * half], &by[(2 * k + col) * half],
+                                      &bz[(2 * r + col) * half]);
+                    }
+                }
+            }
+            // The images of P are orthogonal with squared norm 2.
+            for (size_t t = 0; t < 4; t++) {
+                for (size_t e = 0; e < 4; e++) {
+                    if (level.rep[t][e] == 0) {
+                        continue;
+                    }
+                    for (size_t s = 0; s < half; s++) {
+                        z[t * half + s] += 0.5f * level.rep[t][e] * bz[e * half + s];
+                    }
+                }
+            }
+        }
+
+        for (size_t mask = 0; mask < size; mask++) {
+            c[mask] += level.sign[mask] * z[level.part[mask] * half + level.sub[mask]];
+        }
+    }
+};
+
+/**
+ * Work-stealing task scheduler with one worker per core.
+ *
+ * parallel_for(count, body) calls body(begin, end) over disjoint ranges
+ * covering [0, count). Ranges are split lazily: a worker halves its range
+ * until it is no larger than the job's grain, leaving the upper halves on
+ * its own deque where idle workers steal them from the other end. The grain
+ * starts coarse and shrinks to roughly `target` worth of measured work per
+ * chunk, so expensive elements such as dense products spread out while cheap
+ * ones stay in large chunks. The calling thread helps until its job is done,
+ * which also makes nested calls from inside a body safe. If a body throws,
+ * the remaining ranges of that job are skipped and the first exception is
+ * rethrown on the calling thread once every range has been accounted for.
+ */
+class TaskScheduler {
+public:
+    static constexpr std::chrono::nanoseconds target{50'000};
+
+    explicit TaskScheduler(size_t workers = std::max(1u, std::thread::hardware_concurrency()))
+        : m_queues(workers + 1) {
+        for (size_t i = 0; i < workers; i++) {
+            m_workers.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    ~TaskScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto &t : m_workers) {
+            t.join();
+        }
+    }
+
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+    static TaskScheduler &instance() {
+        static TaskScheduler scheduler;
+        return scheduler;
+    }
+
+    size_t concurrency() const {
+        return m_workers.size();
+    }
+
+    template <class Body>
+    void parallel_for(size_t count, Body &&body) {
+        if (count == 0) {
+            return;
+        }
+        Job job;
+        job.count = count;
+        job.initial_grain = std::max<size_t>(1, count / (4 * m_queues.size()));
+        job.context = &body;
+        job.invoke = [](void *context, size_t begin, size_t end) {
+            (*static_cast<std::remove_reference_t<Body> *>(context))(begin, end);
+        };
+        job.remaining.store(count, std::memory_order_relaxed);
+
+        // Threads outside the pool share the last queue.
+        const size_t index = s_owner == this ? s_index : m_workers.size();
+        push(index, {&job, 0, count});
+        while (job.remaining.load(std::memory_order_acquire) > 0) {
+            Task task;
+            if (find(index, task)) {
+                execute(index, task);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        if (job.error) {
+            std::rethrow_exception(job.error);
+        }
+    }
+
+private:
+    struct Job {
+        void (*invoke)(void *, size_t, size_t);
+        void *context;
+        size_t count;
+        size_t initial_grain;
+        std::atomic<size_t> remaining;
+        // The first exception thrown by a body; set at most once, before remaining drops.
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        // Running estimate of the cost of one element, in nanoseconds.
+        std::atomic<uint64_t> cost{0};
+
+        size_t grain() const {
+            uint64_t c = cost.load(std::memory_order_relaxed);
+            if (c == 0) {
+                return initial_grain;
+            }
+            return std::clamp<size_t>(target.count() / c, 1, initial_grain);
+        }
+    };
+
+    struct Task {
+        Job *job;
+        size_t begin;
+        size_t end;
+    };
+
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void work(size_t index) {
+        s_owner = this;
+        s_index = index;
+        while (true) {
+            Task task;
+            if (find(index, task)) {
+                execute(index, task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_sleep_mutex);
+            m_wake.wait(lock, [this] { return m_stop || m_pending.load() > 0; });
+            if (m_stop && m_pending.load() == 0) {
+                return;
+            }
+        }
+    }
+
+    void push(size_t index, Task task) {
+        // Count first so that m_pending never drops below the number of queued tasks.
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_pending++;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_queues[index].mutex);
+            m_queues[index].tasks.push_back(task);
+        }
+        m_wake.notify_one();
+    }
+
+    bool find(size_t index, Task &task) {
+        {
+            Queue &own = m_queues[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = own.tasks.back();
+                own.tasks.pop_back();
+                m_pending--;
+                return true;
+            }
+        }
+        for (size_t offset = 1; offset < m_queues.size(); offset++) {
+            Queue &victim = m_queues[(index + offset) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                m_pending--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void execute(size_t index, Task task) {
+        Job &job = *task.job;
+        const size_t grain = job.grain();
+        while (task.end - task.begin > grain) {
+            size_t middle = task.begin + (task.end - task.begin) / 2;
+            push(index, {&job, middle, task.end});
+            task.end = middle;
+        }
+
+        const size_t done = task.end - task.begin;
+        if (!job.failed.load(std::memory_order_relaxed)) {
+            const auto start = std::chrono::steady_clock::now();
+            MULTIVECTOR_TRACE_SPAN(span, "parallel_for", done, 0);
+            try {
+                job.invoke(job.context, task.begin, task.end);
+                const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start);
+                uint64_t measured = std::max<uint64_t>(1, elapsed.count() / done);
+                uint64_t previous = job.cost.load(std::memory_order_relaxed);
+                job.cost.store(previous == 0 ? measured : (3 * previous + measured) / 4,
+                               std::memory_order_relaxed);
+            } catch (...) {
+                if (!job.failed.exchange(true, std::memory_order_acq_rel)) {
+                    job.error = std::current_exception();
+                }
+            }
+        }
+        // The job may be destroyed as soon as this reaches zero.
+        job.remaining.fetch_sub(done, std::memory_order_acq_rel);
+    }
+
+    inline static thread_local const TaskScheduler *s_owner = nullptr;
+    inline static thread_local size_t s_index = 0;
+
+    std::vector<Queue> m_queues;
+    std::vector<std::thread> m_workers;
+    std::atomic<size_t> m_pending{0};
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_wake;
+    bool m_stop = false;
+};
+
+/**
+ * Calls function(item) for every element of a contiguous range, on the
+ * shared TaskScheduler.
+ */
+template <std::ranges::contiguous_range Range, class Function>
+void parallel_for(Range &&items, Function &&function) {
+    auto *data = std::ranges::data(items);
+    TaskScheduler::instance().parallel_for(std::ranges::size(items), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            function(data[i]);
+        }
+    });
+}
+
+/**
+ * Returns {function(item) for item in items}, computed on the shared
+ * TaskScheduler, e.g. parallel_transform(points, [&](auto &x) { return R * x * ~R; }).
+ */
+template <std::ranges::contiguous_range Range, class Function>
+auto parallel_transform(const Range &items, Function &&function) {
+    using Item = std::ranges::range_value_t<Range>;
+    using Result = std::decay_t<std::invoke_result_t<Function &, const Item &>>;
+
+    const auto *data = std::ranges::data(items);
+    const size_t count = std::ranges::size(items);
+    // Multivector has no default state, so results are staged until all are ready.
+    std::vector<std::optional<Result>> staged(count);
+    TaskScheduler::instance().parallel_for(count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            staged[i].emplace(function(data[i]));
+        }
+    });
+
+    std::vector<Result> results;
+    results.reserve(count);
+    for (auto &r : staged) {
+        results.push_back(std::move(*r));
+    }
+    return results;
+}
+
+/**
+ * Multithreaded product for large sparse multivectors.
+ *
+ * The left operand's blades are split into contiguous chunks, one per thread,
+ * and each thread accumulates into its own hash table. The partial results
+ * are then sharded by mask hash so that every thread merges a disjoint part
+ * of the output without locking. Both passes run on TaskScheduler. Products
+ * with fewer than `threshold` blade pairs run sequentially through operator*.
+ */
+struct ParallelProduct {
+    inline static size_t threshold = size_t(1) << 20;
+    inline static size_t threads = std::max(1u, std::thread::hardware_concurrency());
+
+    template <class Signature>
+    static Multivector<Signature> multiply(const Multivector<Signature> &A, const Multivector<Signature> &B) {
+        using V = Multivector<Signature>;
+        const auto left = A.blade_vector();
+        const auto right = B.blade_vector();
+        const size_t workers = std::min(threads, left.size());
+        if (workers < 2 || left.size() * right.size() < threshold) {
+            return A * B;
+        }
+        MULTIVECTOR_TRACE_SPAN(span, "ParallelProduct", A.size(), B.size());
+
+        using Shard = std::vector<std::pair<uint64_t, float>>;
+        std::vector<std::vector<Shard>> shards(workers, std::vector<Shard>(workers));
+        run(workers, [&](size_t w) {
+            std::unordered_map<uint64_t, float> local;
+            local.reserve(2 * right.size());
+            for (size_t i = w * left.size() / workers; i < (w + 1) * left.size() / workers; i++) {
+                const auto &a = left[i];
+                for (const auto &b : right) {
+                    float coeff = a.coefficient * b.coefficient * V::sign(a.mask, b.mask);
+                    if (coeff != 0.0f) {
+                        local[a.mask ^ b.mask] += coeff;
+                    }
+                }
+            }
+            for (const auto &[mask, coeff] : local) {
+                shards[w][shard(mask, workers)].emplace_back(mask, coeff);
+            }
+        });
+
+        std::vector<std::vector<typename V::Blade>> merged(workers);
+        run(workers, [&](size_t w) {
+            std::unordered_map<uint64_t, float> total;
+            for (size_t source = 0; source < workers; source++) {
+                for (const auto &[mask, coeff] : shards[source][w]) {
+                    total[mask] += coeff;
+                }
+            }
+            merged[w].reserve(total.size());
+            for (const auto &[mask, coeff] : total) {
+                if (coeff != 0.0f) {
+                    merged[w].push_back({coeff, mask});
+                }
+            }
+        });
+
+        V result;
+        for (const auto &part : merged) {
+            for (const auto &b : part) {
+                result.push_blade(b.coefficient, b.mask);
+            }
+        }
+        // The same compaction and representation switch as operator*.
+        result.auto_compact();
+        MULTIVECTOR_TRACE_RESULT(span, result.size());
+        return result;
+    }
+
+private:
+    static size_t shard(uint64_t mask, size_t count) {
+        return ((mask * 0x9E3779B97F4A7C15ULL) >> 32) % count;
+    }
+
+    template <class Function>
+    static void run(size_t workers, Function &&function) {
+        TaskScheduler::instance().parallel_for(workers, [&](size_t begin, size_t end) {
+            for (size_t w = begin; w < end; w++) {
+                function(w);
+            }
+        });
+    }
+};
+
+/**
+ * Binary multivector format.
+ *
+ * A file holds one batch: a BinaryHeader, `count + 1` uint64 blade offsets,
+ * then the masks of all blades as uint64 and their coefficients as float, in
+ * native byte order. Every array is naturally aligned relative to the start
+ * of the file, so a mapped file can be read in place by MultivectorView.
+ */
+struct BinaryHeader {
+    static constexpr char expected_magic[4] = {'G', 'A', 'M', 'V'};
+    static constexpr uint32_t current_version = 2;
+    static constexpr uint32_t float32 = 1;
+
+    char magic[4];
+    uint32_t version;
+    uint32_t dimension;
+    uint32_t scalar_type;
+    // Bit i holds Signature::value(i).
+    uint64_t signature;
+    // Bit i is set if basis vector i is degenerate. Added in version 2.
+    uint64_t degenerate;
+    uint64_t count;
+};
+
+static_assert(sizeof(BinaryHeader) == 40, "BinaryHeader layout must not change without a version bump");
+
+template <class Signature>
+class BinarySerializer {
+public:
+    static BinaryHeader header(uint64_t count) {
+        BinaryHeader h{};
+        std::memcpy(h.magic, BinaryHeader::expected_magic, sizeof(h.magic));
+        h.version = BinaryHeader::current_version;
+        h.dimension = Signature::max_dimension();
+        h.scalar_type = BinaryHeader::float32;
+        for (size_t i = 0; i < Signature::max_dimension(); i++) {
+            h.signature |= uint64_t(Signature::value(i) != 0) << i;
+            h.degenerate |= uint64_t(is_degenerate<Signature>(i)) << i;
+        }
+        h.count = count;
+        return h;
+    }
+
+    static void check(const BinaryHeader &h) {
+        const BinaryHeader expected = header(h.count);
+        if (std::memcmp(h.magic, expected.magic, sizeof(h.magic)) != 0) {
+            throw std::runtime_error("Not a multivector file");
+        }
+        if (h.version != expected.version) {
+            throw std::runtime_error("Unsupported multivector file version " + std::to_string(h.version));
+        }
+        if (h.dimension != expected.dimension || h.signature != expected.signature ||
+            h.degenerate != expected.degenerate || h.scalar_type != expected.scalar_type) {
+            throw std::runtime_error("Multivector file was written for another signature or scalar type");
+        }
+    }
+
+    static void write(std::ostream &os, std::span<const Multivector<Signature>> batch) {
+        const BinaryHeader h = header(batch.size());
+        os.write(reinterpret_cast<const char *>(&h), sizeof(h));
+
+        std::vector<uint64_t> offsets = {0};
+        for (const auto &v : batch) {
+            offsets.push_back(offsets.back() + v.size());
+        }
+        write_array(os, offsets.data(), offsets.size());
+
+        std::vector<uint64_t> masks;
+        for (const auto &v : batch) {
+            masks.clear();
+            for (const auto &b : v.blades()) {
+                masks.push_back(b.mask);
+            }
+            write_array(os, masks.data(), masks.size());
+        }
+        std::vector<float> coefficients;
+        for (const auto &v : batch) {
+            coefficients.clear();
+            for (const auto &b : v.blades()) {
+                coefficients.push_back(b.coefficient);
+            }
+            write_array(os, coefficients.data(), coefficients.size());
+        }
+        if (!os) {
+            throw std::runtime_error("Failed to write multivector file");
+        }
+    }
+
+    static void write(std::ostream &os, const Multivector<Signature> &v) {
+        write(os, std::span<const Multivector<Signature>>(&v, 1));
+    }
+
+    static std::vector<Multivector<Signature>> read(std::istream &is) {
+        BinaryHeader h;
+        read_array(is, &h, 1);
+        check(h);
+        if (h.count >= std::numeric_limits<uint64_t>::max() / sizeof(uint64_t)) {
+            throw std::runtime_error("Corrupt multivector file: blade count out of range");
+        }
+
+        const std::vector<uint64_t> offsets = read_vector<uint64_t>(is, h.count + 1);
+        check_offsets(offsets.data(), h.count, std::numeric_limits<uint64_t>::max() / sizeof(uint64_t));
+        const std::vector<uint64_t> masks = read_vector<uint64_t>(is, offsets.back());
+        const std::vector<float> coefficients = read_vector<float>(is, offsets.back());
+
+        return assemble(offsets.data(), masks.data(), coefficients.data(), h.count);
+    }
+
+    // offsets[0 .. count] must start at 0, never decrease and end at no more than `total`.
+    static void check_offsets(const uint64_t *offsets, uint64_t count, uint64_t total) {
+        if (offsets[0] != 0 || offsets[count] > total) {
+            throw std::runtime_error("Corrupt multivector file: blade offsets out of range");
+        }
+        for (uint64_t i = 0; i < count; i++) {
+            if (offsets[i + 1] < offsets[i]) {
+                throw std::runtime_error("Corrupt multivector file: blade offsets decrease");
+            }
+        }
+    }
+
+    // Every mask must lie within the signature and appear once per multivector.
+    static void check_masks(const uint64_t *masks, size_t size) {
+        std::vector<uint64_t> sorted(masks, masks + size);
+        std::sort(sorted.begin(), sorted.end());
+        if (!sorted.empty() && sorted.back() > Multivector<Signature>::pseudoscalar_mask()) {
+            throw std::runtime_error("Corrupt multivector file: blade outside of signature bounds");
+        }
+        if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+            throw std::runtime_error("Corrupt multivector file: duplicate blade");
+        }
+    }
+
+    static Multivector<Signature> assemble_one(const uint64_t *masks, const float *coefficients, size_t size) {
+        check_masks(masks, size);
+        Multivector<Signature> v;
+        v.reserve(size);
+        for (size_t i = 0; i < size; i++) {
+            v.push_blade(coefficients[i], masks[i]);
+        }
+        return v;
+    }
+
+private:
+    static std::vector<Multivector<Signature>> assemble(const uint64_t *offsets, const uint64_t *masks,
+                                                        const float *coefficients, size_t count) {
+        std::vector<Multivector<Signature>> batch;
+        batch.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            batch.push_back(assemble_one(masks + offsets[i], coefficients + offsets[i], offsets[i + 1] - offsets[i]));
+        }
+        return batch;
+    }
+
+    template <class T>
+    static void write_array(std::ostream &os, const T *data, size_t size) {
+        os.write(reinterpret_cast<const char *>(data), size * sizeof(T));
+    }
+
+    template <class T>
+    static void read_array(std::istream &is, T *data, size_t size) {
+        if (!is.read(reinterpret_cast<char *>(data), size * sizeof(T))) {
+            throw std::runtime_error("Truncated multivector file");
+        }
+    }
+
+    // Grows in chunks, so a corrupt size runs into the end of the stream
+    // before it turns into a huge allocation.
+    template <class T>
+    static std::vector<T> read_vector(std::istream &is, uint64_t size) {
+        constexpr uint64_t chunk = 1 << 16;
+        std::vector<T> data;
+        while (data.size() < size) {
+            const size_t start = data.size();
+            data.resize(start + std::min(chunk, size - start));
+            read_array(is, data.data() + start, data.size() - start);
+        }
+        return data;
+    }
+};
+
+/**
+ * Read-only, zero-copy view of a binary multivector file.
+ *
+ * The file is mapped with mmap and blades are read straight out of the
+ * mapping; nothing is parsed or copied until to_multivector() is called.
+ */
+template <class Signature>
+class MultivectorView {
+public:
+    struct Blade {
+        float coefficient;
+        uint64_t mask;
+    };
+
+    class Blades {
+    public:
+        class iterator {
+        public:
+            using value_type = Blade;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+            iterator(const uint64_t *mask, const float *coefficient) : m_mask(mask), m_coefficient(coefficient) {}
+
+            Blade operator*() const {
+                return {*m_coefficient, *m_mask};
+            }
+
+            iterator &operator++() {
+                m_mask++;
+                m_coefficient++;
+                return *this;
+            }
+
+            iterator operator++(int) {
+                iterator previous = *this;
+                ++*this;
+                return previous;
+            }
+
+            bool operator==(const iterator &other) const {
+                return m_mask == other.m_mask;
+            }
+
+        private:
+            const uint64_t *m_mask = nullptr;
+            const float *m_coefficient = nullptr;
+        };
+
+        Blades(const uint64_t *masks, const float *coefficients, size_t size)
+            : m_masks(masks), m_coefficients(coefficients), m_size(size) {}
+
+        size_t size() const {
+            return m_size;
+        }
+
+        Blade operator[](size_t i) const {
+            return {m_coefficients[i], m_masks[i]};
+        }
+
+        std::span<const uint64_t> masks() const {
+            return {m_masks, m_size};
+        }
+
+        std::span<const float> coefficients() const {
+            return {m_coefficients, m_size};
+        }
+
+        iterator begin() const {
+            return {m_masks, m_coefficients};
+        }
+
+        iterator end() const {
+            return {m_masks + m_size, m_coefficients + m_size};
+        }
+
+    private:
+        const uint64_t *m_masks;
+        const float *m_coefficients;
+        size_t m_size;
+    };
+
+    explicit MultivectorView(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(BinaryHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Truncated multivector file");
+        }
+        m_length = st.st_size;
+        m_data = ::mmap(nullptr, m_length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (m_data == MAP_FAILED) {
+            m_data = nullptr;
+            throw std::runtime_error("Cannot map " + path);
+        }
+
+        try {
+            const auto *bytes = static_cast<const char *>(m_data);
+            const auto *h = reinterpret_cast<const BinaryHeader *>(bytes);
+            BinarySerializer<Signature>::check(*h);
+            m_count = h->count;
+            m_offsets = reinterpret_cast<const uint64_t *>(bytes + sizeof(BinaryHeader));
+            if ((m_length - sizeof(BinaryHeader)) / sizeof(uint64_t) <= m_count) {
+                throw std::runtime_error("Truncated multivector file");
+            }
+            const size_t remaining = m_length - sizeof(BinaryHeader) - (m_count + 1) * sizeof(uint64_t);
+            BinarySerializer<Signature>::check_offsets(m_offsets, m_count,
+                                                       remaining / (sizeof(uint64_t) + sizeof(float)));
+            const uint64_t total = m_offsets[m_count];
+            m_masks = m_offsets + m_count + 1;
+            m_coefficients = reinterpret_cast<const float *>(m_masks + total);
+        } catch (...) {
+            ::munmap(m_data, m_length);
+            throw;
+        }
+    }
+
+    ~MultivectorView() {
+        if (m_data) {
+            ::munmap(m_data, m_length);
+        }
+    }
+
+    MultivectorView(const MultivectorView &) = delete;
+    MultivectorView &operator=(const MultivectorView &) = delete;
+
+    MultivectorView(MultivectorView &&other) noexcept {
+        *this = std::move(other);
+    }
+
+    MultivectorView &operator=(MultivectorView &&other) noexcept {
+        std::swap(m_data, other.m_data);
+        std::swap(m_length, other.m_length);
+        std::swap(m_count, other.m_count);
+        std::swap(m_offsets, other.m_offsets);
+        std::swap(m_masks, other.m_masks);
+        std::swap(m_coefficients, other.m_coefficients);
+        return *this;
+    }
+
+    size_t size() const {
+        return m_count;
+    }
+
+    Blades operator[](size_t i) const {
+        if (i >= m_count) {
+            throw std::out_of_range("Multivector index outside of file");
+        }
+        return {m_masks + m_offsets[i], m_coefficients + m_offsets[i], m_offsets[i + 1] - m_offsets[i]};
+    }
+
+    Multivector<Signature> to_multivector(size_t i) const {
+        Blades b = (*this)[i];
+        return BinarySerializer<Signature>::assemble_one(b.masks().data(), b.coefficients().data(), b.size());
+    }
+
+private:
+    void *m_data = nullptr;
+    size_t m_length = 0;
+    size_t m_count = 0;
+    const uint64_t *m_offsets = nullptr;
+    const uint64_t *m_masks = nullptr;
+    const float *m_coefficients = nullptr;
+};
+
+/**
+ * Text parsing and formatting of multivectors.
+ *
+ * parse() accepts the form printed by operator<<, one `coeff * e(mask)` term
+ * per line, and the named-basis form `3*e12 - 0.5*e3`, where the digits after
+ * `e` are the 1-based, strictly ascending indices of the basis vectors in the
+ * blade (so e12 is e(3)). Indices past the ninth are written in braces,
+ * separated by commas, as in e{1,10}. A term may be a bare coefficient (the
+ * e(0) blade) or a bare blade (coefficient 1). Coefficients follow the
+ * std::from_chars float syntax, so `3e12` is the number 3 * 10^12, and a
+ * coefficient is joined to its blade by `*`; `3 e12` is rejected.
+ * A batch is a sequence of such texts separated by blank lines.
+ *
+ * format() writes the printed form into a caller buffer using the shortest
+ * round-trip representation of each coefficient. Like std::to_chars, it
+ * reports std::errc::value_too_large when the buffer is too small.
+ */
+template <class Signature>
+class TextFormat {
+public:
+    static Multivector<Signature> parse(std::string_view text) {
+        Multivector<Signature> result;
+        const char *p = text.data(), *last = text.data() + text.size();
+        p = skip_space(p, last);
+        while (p != last) {
+            float sign = 1.0f;
+            if (*p == '+' || *p == '-') {
+                sign = *p == '-' ? -1.0f : 1.0f;
+                p = skip_space(p + 1, last);
+                // from_chars would otherwise read a second sign as part of the coefficient.
+                if (p != last && (*p == '+' || *p == '-')) {
+                    fail(text, p, "expected a coefficient or a basis blade after the sign");
+                }
+            }
+
+            float coeff = 1.0f;
+            bool has_coeff = false;
+            if (p != last && *p != 'e') {
+                auto [end, ec] = std::from_chars(p, last, coeff);
+                if (ec != std::errc()) {
+                    fail(text, p, "expected a coefficient or a basis blade");
+                }
+                has_coeff = true;
+                p = skip_space(end, last);
+                if (p != last && *p == '*') {
+                    p = skip_space(p + 1, last);
+                    if (p == last || *p != 'e') {
+                        fail(text, p, "expected a basis blade after '*'");
+                    }
+                } else if (p != last && *p == 'e') {
+                    fail(text, p, "expected '*' between a coefficient and its blade");
+                }
+            }
+
+            uint64_t mask = 0;
+            if (p != last && *p == 'e') {
+                p = parse_blade(text, p + 1, last, mask);
+            } else if (!has_coeff) {
+                fail(text, p, "expected a coefficient or a basis blade");
+            }
+            if (mask > Multivector<Signature>::pseudoscalar_mask()) {
+                fail(text, p, "blade outside of signature bounds");
+            }
+
+            result.add_blade(sign * coeff, mask);
+            p = skip_space(p, last);
+        }
+        return result;
+    }
+
+    static std::vector<Multivector<Signature>> parse_batch(std::string_view text) {
+        std::vector<Multivector<Signature>> batch;
+        size_t record = 0, line = 0;
+        bool has_content = false;
+        while (line <= text.size()) {
+            size_t end = std::min(text.find('\n', line), text.size());
+            std::string_view current = text.substr(line, end - line);
+            bool blank = current.find_first_not_of(" \t\r") == std::string_view::npos;
+            if (blank || end == text.size()) {
+                if (!blank) {
+                    has_content = true;
+                }
+                if (has_content) {
+                    batch.push_back(parse(text.substr(record, (blank ? line : end) - record)));
+                }
+                record = end + 1;
+                has_content = false;
+            } else {
+                has_content = true;
+            }
+            line = end + 1;
+        }
+        return batch;
+    }
+
+    static std::to_chars_result format(char *first, char *last, const Multivector<Signature> &v) {
+        if (v.size() == 0) {
+            return format_blade(first, last, 0.0f, 0);
+        }
+        bool leading = true;
+        for (const auto &b : v.blades()) {
+            if (!leading) {
+                if (first == last) {
+                    return {last, std::errc::value_too_large};
+                }
+                *first++ = '\n';
+            }
+            leading = false;
+            auto r = format_blade(first, last, b.coefficient, b.mask);
+            if (r.ec != std::errc()) {
+                return r;
+            }
+            first = r.ptr;
+        }
+        return {first, std::errc()};
+    }
+
+    // Each multivector is followed by a blank line, as parse_batch expects.
+    static std::to_chars_result format_batch(char *first, char *last, std::span<const Multivector<Signature>> batch) {
+        for (const auto &v : batch) {
+            auto r = format(first, last, v);
+            if (r.ec != std::errc() || last - r.ptr < 2) {
+                return {last, std::errc::value_too_large};
+            }
+            first = r.ptr;
+            *first++ = '\n';
+            *first++ = '\n';
+        }
+        return {first, std::errc()};
+    }
+
+private:
+    static const char *skip_space(const char *p, const char *last) {
+        while (p != last && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+            p++;
+        }
+        return p;
+    }
+
+    static const char *parse_blade(std::string_view text, const char *p, const char *last, uint64_t &mask) {
+        if (p != last && *p == '(') {
+            auto [end, ec] = std::from_chars(p + 1, last, mask);
+            if (ec != std::errc() || end == last || *end != ')') {
+                fail(text, p, "expected e(mask)");
+            }
+            return end + 1;
+        }
+
+        size_t previous = 0;
+        auto add_index = [&](size_t index, const char *at) {
+            if (index == 0) {
+                fail(text, at, "basis indices start at 1");
+            }
+            if (index <= previous) {
+                fail(text, at, "basis indices must be strictly ascending");
+            }
+            if (index > Signature::max_dimension()) {
+                fail(text, at, "blade outside of signature bounds");
+            }
+            mask |= 1ULL << (index - 1);
+            previous = index;
+        };
+
+        if (p != last && *p == '{') {
+            do {
+                p = skip_space(p + 1, last);
+                size_t index = 0;
+                auto [end, ec] = std::from_chars(p, last, index);
+                if (ec != std::errc()) {
+                    fail(text, p, "expected a basis index in e{...}");
+                }
+                add_index(index, p);
+                p = skip_space(end, last);
+            } while (p != last && *p == ',');
+            if (p == last || *p != '}') {
+                fail(text, p, "expected '}' after basis indices");
+            }
+            return p + 1;
+        }
+
+        const char *start = p;
+        while (p != last && *p >= '1' && *p <= '9') {
+            add_index(*p - '0', p);
+            p++;
+        }
+        if (p == start) {
+            fail(text, p, "expected basis indices after 'e'");
+        }
+        return p;
+    }
+
+    static std::to_chars_result format_blade(char *first, char *last, float coeff, uint64_t mask) {
+        auto r = std::to_chars(first, last, coeff);
+        if (r.ec != std::errc() || last - r.ptr < 5) {
+            return {last, std::errc::value_too_large};
+        }
+        std::memcpy(r.ptr, " * e(", 5);
+        r = std::to_chars(r.ptr + 5, last, mask);
+        if (r.ec != std::errc() || r.ptr == last) {
+            return {last, std::errc::value_too_large};
+        }
+        *r.ptr++ = ')';
+        return r;
+    }
+
+    [[noreturn]] static void fail(std::string_view text, const char *p, const char *what) {
+        throw std::invalid_argument(std::string("Cannot parse multivector at offset ") +
+                                    std::to_string(p - text.data()) + ": " + what);
+    }
+};
+
+/**
+ * Precompiled product of two fixed blade sets.
+ *
+ * compile() runs the sign and output-blade search of operator* once and
+ * records the product as a flat list of (lhs index, rhs index, output index,
+ * sign) terms; execute() then only multiplies and accumulates coefficients.
+ * Plans are immutable, so one plan can be executed from many threads.
+ * cached() looks plans up in a process-wide concurrent cache keyed by a hash
+ * of both mask sequences, which is what PlannedProduct uses. The cache holds
+ * at most about `capacity` plans: a shard that fills its share is emptied,
+ * which frees plans nobody still holds.
+ */
+template <class Signature>
+class ProductPlan {
+public:
+    inline static size_t capacity = 4096;
+
+    static std::shared_ptr<const ProductPlan> compile(std::span<const uint64_t> lhs, std::span<const uint64_t> rhs) {
+        auto plan = std::shared_ptr<ProductPlan>(new ProductPlan);
+        plan->m_lhs.assign(lhs.begin(), lhs.end());
+        plan->m_rhs.assign(rhs.begin(), rhs.end());
+
+        std::unordered_map<uint64_t, uint32_t> outputs;
+        for (uint32_t i = 0; i < lhs.size(); i++) {
+            for (uint32_t j = 0; j < rhs.size(); j++) {
+                float s = static_cast<float>(Multivector<Signature>::sign(lhs[i], rhs[j]));
+                if (s == 0.0f) {
+                    continue;
+                }
+                uint64_t mask = lhs[i] ^ rhs[j];
+                auto [it, inserted] = outputs.try_emplace(mask, static_cast<uint32_t>(plan->m_output.size()));
+                if (inserted) {
+                    plan->m_output.push_back(mask);
+                }
+                plan->m_terms.push_back({i, j, it->second, s});
+            }
+        }
+        // Grouping by output keeps the accumulator in a register.
+        std::stable_sort(plan->m_terms.begin(), plan->m_terms.end(),
+                         [](const Term &x, const Term &y) { return x.out < y.out; });
+        return plan;
+    }
+
+    static std::shared_ptr<const ProductPlan> cached(std::span<const uint64_t> lhs, std::span<const uint64_t> rhs) {
+        const uint64_t key = hash(lhs, rhs);
+        Shard &shard = cache()[key % shard_count];
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            if (auto plan = find(shard, key, lhs, rhs)) {
+                return plan;
+            }
+        }
+        auto plan = compile(lhs, rhs);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        if (auto existing = find(shard, key, lhs, rhs)) {
+            return existing;
+        }
+        if (shard.plans.size() >= std::max<size_t>(1, capacity / shard_count)) {
+            shard.plans.clear();
+        }
+        shard.plans.emplace(key, plan);
+        return plan;
+    }
+
+    static std::shared_ptr<const ProductPlan> cached(const Multivector<Signature> &A, const Multivector<Signature> &B) {
+        return cached(masks(A), masks(B));
+    }
+
+    static size_t cache_size() {
+        size_t size = 0;
+        for (Shard &shard : cache()) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            size += shard.plans.size();
+        }
+        return size;
+    }
+
+    static void clear_cache() {
+        for (Shard &shard : cache()) {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            shard.plans.clear();
+        }
+    }
+
+    static std::vector<uint64_t> masks(const Multivector<Signature> &v) {
+        std::vector<uint64_t> result;
+        result.reserve(v.size());
+        for (const auto &b : v.blades()) {
+            result.push_back(b.mask);
+        }
+        return result;
+    }
+
+    std::span<const uint64_t> lhs_masks() const {
+        return m_lhs;
+    }
+
+    std::span<const uint64_t> rhs_masks() const {
+        return m_rhs;
+    }
+
+    std::span<const uint64_t> output_masks() const {
+        return m_output;
+    }
+
+    // out has output_masks().size() entries and is overwritten.
+    void execute(const float *lhs, const float *rhs, float *out) const {
+        std::fill(out, out + m_output.size(), 0.0f);
+        for (const Term &t : m_terms) {
+            out[t.out] += t.sign * lhs[t.lhs] * rhs[t.rhs];
+        }
+    }
+
+    // Whether A and B hold exactly the plan's blade masks, in the same order.
+    bool matches(const Multivector<Signature> &A, const Multivector<Signature> &B) const {
+        return matches(A, m_lhs) && matches(B, m_rhs);
+    }
+
+    // A and B must hold exactly the plan's blade masks, in the same order.
+    // Sparse operands are read in place; only the result is allocated.
+    Multivector<Signature> execute(const Multivector<Signature> &A, const Multivector<Signature> &B) const {
+        assert(matches(A, B) && "Operands do not match the product plan");
+        thread_local std::vector<float> lhs_scratch, rhs_scratch, out;
+        out.resize(m_output.size());
+        execute(coefficients(A, lhs_scratch), coefficients(B, rhs_scratch), out.data());
+
+        Multivector<Signature> result;
+        result.reserve(out.size());
+        for (size_t k = 0; k < out.size(); k++) {
+            if (out[k] != 0.0f) {
+                result.push_blade(out[k], m_output[k]);
+            }
+        }
+        return result;
+    }
+
+private:
+    struct Term {
+        uint32_t lhs;
+        uint32_t rhs;
+        uint32_t out;
+        float sign;
+    };
+
+    static constexpr size_t shard_count = 16;
+
+    struct Shard {
+        std::shared_mutex mutex;
+        std::unordered_multimap<uint64_t, std::shared_ptr<const ProductPlan>> plans;
+    };
+
+    ProductPlan() = default;
+
+    static bool matches(const Multivector<Signature> &v, const std::vector<uint64_t> &masks) {
+        size_t i = 0;
+        for (const auto &b : v.blades()) {
+            if (i == masks.size() || b.mask != masks[i++]) {
+                return false;
+            }
+        }
+        return i == masks.size();
+    }
+
+    static const float *coefficients(const Multivector<Signature> &v, std::vector<float> &scratch) {
+        if (!v.dense()) {
+            return v.m_coefficients.data();
+        }
+        scratch.clear();
+        for (const auto &b : v.blades()) {
+            scratch.push_back(b.coefficient);
+        }
+        return scratch.data();
+    }
+
+    static std::array<Shard, shard_count> &cache() {
+        static std::array<Shard, shard_count> shards;
+        return shards;
+    }
+
+    static uint64_t hash(std::span<const uint64_t> lhs, std::span<const uint64_t> rhs) {
+        uint64_t h = 0xCBF29CE484222325ULL ^ (lhs.size() * 0x9E3779B97F4A7C15ULL);
+        for (auto masks : {lhs, rhs}) {
+            for (uint64_t mask : masks) {
+                h = (h ^ mask) * 0x100000001B3ULL;
+                h ^= h >> 29;
+            }
+            h = (h ^ 0xFF) * 0x100000001B3ULL;
+        }
+        return h;
+    }
+
+    static std::shared_ptr<const ProductPlan> find(const Shard &shard, uint64_t key, std::span<const uint64_t> lhs,
+                                                   std::span<const uint64_t> rhs) {
+        auto [first, last] = shard.plans.equal_range(key);
+        for (auto it = first; it != last; ++it) {
+            const ProductPlan &plan = *it->second;
+            if (std::ranges::equal(plan.m_lhs, lhs) && std::ranges::equal(plan.m_rhs, rhs)) {
+                return it->second;
+            }
+        }
+        return nullptr;
+    }
+
+    std::vector<uint64_t> m_lhs;
+    std::vector<uint64_t> m_rhs;
+    std::vector<uint64_t> m_output;
+    std::vector<Term> m_terms;
+};
+
+/**
+ * Product strategy that executes the cached ProductPlan for the operands'
+ * blade masks, for loops that keep multiplying the same sparsity pattern.
+ * Each thread remembers the last plan it used, so a loop over one operand
+ * shape consults the cache once rather than hashing masks on every call.
+ */
+struct PlannedProduct {
+    template <class Signature>
+    static Multivector<Signature> multiply(const Multivector<Signature> &A, const Multivector<Signature> &B) {
+        thread_local std::shared_ptr<const ProductPlan<Signature>> plan;
+        if (!plan || !plan->matches(A, B)) {
+            plan = ProductPlan<Signature>::cached(A, B);
+        }
+        return plan->execute(A, B);
+    }
+};
+
+/**
+ * Compile-time sparsity of the product of two blade sets.
+ *
+ * `outputs` is the ascending set of masks the product can reach and `terms`
+ * lists every contributing pair with its sign, both computed during
+ * compilation from Multivector::sign. `Result` is the StaticMultivector over
+ * `outputs`, and run() expands to one multiply-add per term.
+ */
+template <class Signature, auto Lhs, auto Rhs>
+struct StaticProduct {
+    struct Term {
+        size_t lhs;
+        size_t rhs;
+        size_t out;
+        float sign;
+    };
+
+    // Pairs whose product vanishes under a degenerate metric contribute nothing.
+    static constexpr bool live(uint64_t a, uint64_t b) {
+        return Multivector<Signature>::sign(a, b) != 0;
+    }
+
+    static constexpr size_t term_count = [] {
+        size_t count = 0;
+        for (uint64_t a : Lhs) {
+            for (uint64_t b : Rhs) {
+                count += live(a, b);
+            }
+        }
+        return count;
+    }();
+
+    static constexpr size_t output_count = [] {
+        std::array<uint64_t, Lhs.size() * Rhs.size()> seen{};
+        size_t count = 0;
+        for (uint64_t a : Lhs) {
+            for (uint64_t b : Rhs) {
+                if (live(a, b) && std::find(seen.begin(), seen.begin() + count, a ^ b) == seen.begin() + count) {
+                    seen[count++] = a ^ b;
+                }
+            }
+        }
+        return count;
+    }();
+
+    static constexpr std::array<uint64_t, output_count> outputs = [] {
+        std::array<uint64_t, output_count> result{};
+        size_t count = 0;
+        for (uint64_t a : Lhs) {
+            for (uint64_t b : Rhs) {
+                if (live(a, b) && std::find(result.begin(), result.begin() + count, a ^ b) == result.begin() + count) {
+                    result[count++] = a ^ b;
+                }
+            }
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }();
+
+    static constexpr std::array<Term, term_count> terms = [] {
+        std::array<Term, term_count> result{};
+        size_t t = 0;
+        for (size_t i = 0; i < Lhs.size(); i++) {
+            for (size_t j = 0; j < Rhs.size(); j++) {
+                if (!live(Lhs[i], Rhs[j])) {
+                    continue;
+                }
+                size_t out = std::lower_bound(outputs.begin(), outputs.end(), Lhs[i] ^ Rhs[j]) - outputs.begin();
+                result[t++] = {i, j, out, static_cast<float>(Multivector<Signature>::sign(Lhs[i], Rhs[j]))};
+            }
+        }
+        return result;
+    }();
+
+    template <size_t... I>
+    static auto result_type(std::index_sequence<I...>) -> StaticMultivector<Signature, outputs[I]...>;
+
+    using Result = decltype(result_type(std::make_index_sequence<output_count>()));
+
+    static constexpr void run(const float *a, const float *b, float *out) {
+        run(a, b, out, std::make_index_sequence<terms.size()>());
+    }
+
+private:
+    template <size_t... T>
+    static constexpr void run([[maybe_unused]] const float *a, [[maybe_unused]] const float *b,
+                              [[maybe_unused]] float *out, std::index_sequence<T...>) {
+        ((out[terms[T].out] += terms[T].sign * a[terms[T].lhs] * b[terms[T].rhs]), ...);
+    }
+};
+
+/**
+ * Multivector whose blade set is fixed at compile time, e.g.
+ * StaticMultivector<MinkowskiSignature, 1, 2, 4, 8> for a 4-vector.
+ *
+ * Coefficients live in a std::array in the order of `Masks`. The product of
+ * two static multivectors has its blade set and its term list derived by
+ * StaticProduct, so its type is computed rather than declared and the kernel
+ * is straight-line code.
+ */
+template <class Signature, uint64_t... Masks>
+class StaticMultivector {
+public:
+    static constexpr size_t size = sizeof...(Masks);
+    static constexpr std::array<uint64_t, size> masks = {Masks...};
+
+    static_assert(((Signature::max_dimension() == 64 || Masks < (1ULL << Signature::max_dimension())) && ...),
+                  "Blade outside of signature bounds");
+    static_assert([] {
+        for (size_t i = 0; i < size; i++) {
+            for (size_t j = i + 1; j < size; j++) {
+                if (masks[i] == masks[j]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }(), "Blade masks must be distinct");
+
+    std::array<float, size> coefficients{};
+
+    // Every blade of v must belong to this blade set.
+    static StaticMultivector from(const Multivector<Signature> &v) {
+        StaticMultivector result;
+        for (const auto &b : v.blades()) {
+            size_t i = std::find(masks.begin(), masks.end(), b.mask) - masks.begin();
+            if (i == size) {
+                throw std::out_of_range("Blade outside of the static blade set");
+            }
+            result.coefficients[i] += b.coefficient;
+        }
+        return result;
+    }
+
+    Multivector<Signature> to_multivector() const {
+        Multivector<Signature> result;
+        for (size_t i = 0; i < size; i++) {
+            result.add_blade(coefficients[i], masks[i]);
+        }
+        return result;
+    }
+
+    constexpr StaticMultivector operator+(const StaticMultivector &other) const {
+        StaticMultivector result = *this;
+        for (size_t i = 0; i < size; i++) {
+            result.coefficients[i] += other.coefficients[i];
+        }
+        return result;
+    }
+
+    constexpr StaticMultivector operator-(const StaticMultivector &other) const {
+        StaticMultivector result = *this;
+        for (size_t i = 0; i < size; i++) {
+            result.coefficients[i] -= other.coefficients[i];
+        }
+        return result;
+    }
+
+    constexpr StaticMultivector operator*(float scalar) const {
+        StaticMultivector result = *this;
+        for (float &c : result.coefficients) {
+            c *= scalar;
+        }
+        return result;
+    }
+
+    template <uint64_t... Other>
+    constexpr auto operator*(const StaticMultivector<Signature, Other...> &other) const {
+        using Product = StaticProduct<Signature, masks, StaticMultivector<Signature, Other...>::masks>;
+        typename Product::Result result;
+        Product::run(coefficients.data(), other.coefficients.data(), result.coefficients.data());
+        return result;
+    }
+
+    constexpr StaticMultivector reverse() const {
+        StaticMultivector result = *this;
+        for (size_t i = 0; i < size; i++) {
+            uint64_t grade = __builtin_popcountll(masks[i]);
+            if ((grade * (grade - 1) / 2) % 2) {
+                result.coefficients[i] = -result.coefficients[i];
+            }
+        }
+        return result;
+    }
+
+    constexpr StaticMultivector operator~() const {
+        return reverse();
+    }
+
+    friend constexpr StaticMultivector operator*(float scalar, const StaticMultivector &v) {
+        return v * scalar;
+    }
+};
+
+/**
+ * Dense storage for the even subalgebra, which holds rotors, spinors and
+ * motors and is closed under the product.
+ *
+ * Holds all 2^(N-1) even coefficients. Dropping the lowest bit of an even
+ * mask gives its index, since that bit is the parity of the others, so the
+ * product of the elements at indices i and j lands at index i ^ j and the
+ * kernel is a dense loop over a precomputed sign table. Widening to a
+ * Multivector copies the non-zero coefficients.
+ */
+template <class Signature>
+class Even {
+public:
+    static constexpr size_t dimension = Signature::max_dimension();
+    static_assert(dimension >= 1 && dimension <= 10, "Even storage is limited to 10 dimensions");
+
+    static constexpr size_t size = size_t(1) << (dimension - 1);
+
+    std::array<float, size> coefficients{};
+
+    static constexpr uint64_t mask(size_t index) {
+        return (uint64_t(index) << 1) | (__builtin_popcountll(index) & 1);
+    }
+
+    static constexpr size_t index(uint64_t mask) {
+        return static_cast<size_t>(mask >> 1);
+    }
+
+    // Every blade of v must be even and within the signature.
+    static Even from(const Multivector<Signature> &v) {
+        Even result;
+        for (const auto &b : v.blades()) {
+            if (__builtin_popcountll(b.mask) % 2 != 0 || b.mask > Multivector<Signature>::pseudoscalar_mask()) {
+                throw std::out_of_range("Blade outside of the even subalgebra");
+            }
+            result.coefficients[index(b.mask)] += b.coefficient;
+        }
+        return result;
+    }
+
+    Multivector<Signature> to_multivector() const {
+        Multivector<Signature> result;
+        for (size_t i = 0; i < size; i++) {
+            if (coefficients[i] != 0.0f) {
+                result.push_blade(coefficients[i], mask(i));
+            }
+        }
+        return result;
+    }
+
+    Even operator+(const Even &other) const {
+        Even result = *this;
+        for (size_t i = 0; i < size; i++) {
+            result.coefficients[i] += other.coefficients[i];
+        }
+        return result;
+    }
+
+    Even operator-(const Even &other) const {
+        Even result = *this;
+        for (size_t i = 0; i < size; i++) {
+            result.coefficients[i] -= other.coefficients[i];
+        }
+        return result;
+    }
+
+    Even operator*(float scalar) const {
+        Even result = *this;
+        for (float &c : result.coefficients) {
+            c *= scalar;
+        }
+        return result;
+    }
+
+    Even operator*(const Even &other) const {
+        static const std::vector<float> signs = build_signs();
+        Even result;
+        for (size_t i = 0; i < size; i++) {
+            const float a = coefficients[i];
+            if (a == 0.0f) {
+                continue;
+            }
+            const float *row = signs.data() + i * size;
+            for (size_t j = 0; j < size; j++) {
+                result.coefficients[i ^ j] += row[j] * a * other.coefficients[j];
+            }
+        }
+        return result;
+    }
+
+    Even reverse() const {
+        Even result = *this;
+        for (size_t i = 0; i < size; i++) {
+            uint64_t grade = __builtin_popcountll(mask(i));
+            if ((grade * (grade - 1) / 2) % 2) {
+                result.coefficients[i] = -result.coefficients[i];
+            }
+        }
+        return result;
+    }
+
+    Even operator~() const {
+        return reverse();
+    }
+
+    friend Even operator*(float scalar, const Even &v) {
+        return v * scalar;
+    }
+
+private:
+    static std::vector<float> build_signs() {
+        std::vector<float> signs(size * size);
+        for (size_t i = 0; i < size; i++) {
+            for (size_t j = 0; j < size; j++) {
+                signs[i * size + j] = static_cast<float>(Multivector<Signature>::sign(mask(i), mask(j)));
+            }
+        }
+        return signs;
+    }
+};
+
+/**
+ * Rigid-body motor of the projective geometric algebra of ProjectiveSignature.
+ *
+ * Holds exactly the eight even coefficients e(0) e(3) e(5) e(6) e(9) e(10)
+ * e(12) e(15) in a 32-byte aligned array, rotational part first. Products
+ * and sandwiches are straight-line kernels generated by codegen for
+ * ProjectiveSignature, so they agree with ProjectiveMultivector and contain
+ * no terms through e(8) * e(8). Since e(0) is minus the identity, the
+ * identity motor has e(0) coefficient -1.
+ */
+class Motor {
+public:
+    using Plane = StaticMultivector<ProjectiveSignature, 1, 2, 4, 8>;
+    using Line = StaticMultivector<ProjectiveSignature, 3, 5, 6, 9, 10, 12>;
+    using Point = StaticMultivector<ProjectiveSignature, 7, 11, 13, 14>;
+    using Even = StaticMultivector<ProjectiveSignature, 0, 3, 5, 6, 9, 10, 12, 15>;
+
+    static constexpr std::array<uint64_t, 8> masks = Even::masks;
+
+    alignas(32) std::array<float, 8> coefficients{};
+
+    static constexpr Motor identity() {
+        return {{-1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f}};
+    }
+
+    // Every blade of v must be even.
+    static Motor from(const ProjectiveMultivector &v) {
+        Motor m;
+        m.coefficients = Even::from(v).coefficients;
+        return m;
+    }
+
+    ProjectiveMultivector to_multivector() const {
+        return Even{coefficients}.to_multivector();
+    }
+
+    constexpr Motor operator*(const Motor &other) const {
+        const float *a = coefficients.data(), *b = other.coefficients.data();
+        return {{
+            -a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3],
+            -a[0] * b[1] - a[1] * b[0] + a[2] * b[3] - a[3] * b[2],
+            -a[0] * b[2] - a[1] * b[3] - a[2] * b[0] + a[3] * b[1],
+            -a[0] * b[3] + a[1] * b[2] - a[2] * b[1] - a[3] * b[0],
+            -a[0] * b[4] - a[1] * b[5] - a[2] * b[6] + a[3] * b[7] - a[4] * b[0] + a[5] * b[1] + a[6] * b[2] + a[7] * b[3],
+            -a[0] * b[5] + a[1] * b[4] - a[2] * b[7] - a[3] * b[6] - a[4] * b[1] - a[5] * b[0] + a[6] * b[3] - a[7] * b[2],
+            -a[0] * b[6] + a[1] * b[7] + a[2] * b[4] + a[3] * b[5] - a[4] * b[2] - a[5] * b[3] - a[6] * b[0] + a[7] * b[1],
+            -a[0] * b[7] - a[1] * b[6] + a[2] * b[5] - a[3] * b[4] - a[4] * b[3] + a[5] * b[2] - a[6] * b[1] - a[7] * b[0],
+        }};
+    }
+
+    constexpr Motor reverse() const {
+        const float *a = coefficients.data();
+        return {{a[0], -a[1], -a[2], -a[3], -a[4], -a[5], -a[6], a[7]}};
+    }
+
+    constexpr Motor operator~() const {
+        return reverse();
+    }
+
+    // M * p * ~M
+    constexpr Point apply(const Point &point) const {
+        const float *a = coefficients.data(), *b = point.coefficients.data();
+        // t = M * p, odd: e(1) e(2) e(4) e(7) e(8) e(11) e(13) e(14)
+        const float t[8] = {
+            a[3] * b[0],
+            -a[2] * b[0],
+            a[1] * b[0],
+            -a[0] * b[0],
+            a[1] * b[1] + a[2] * b[2] + a[3] * b[3] - a[7] * b[0],
+            -a[0] * b[1] + a[2] * b[3] - a[3] * b[2] + a[6] * b[0],
+            -a[0] * b[2] - a[1] * b[3] + a[3] * b[1] - a[5] * b[0],
+            -a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[4] * b[0],
+        };
+        return {odd_times_reverse<3, 5, 6, 7>(t)};
+    }
+
+    // M * p * ~M
+    constexpr Plane apply(const Plane &plane) const {
+        const float *a = coefficients.data(), *b = plane.coefficients.data();
+        // t = M * p, odd: e(1) e(2) e(4) e(7) e(8) e(11) e(13) e(14)
+        const float t[8] = {
+            -a[0] * b[0] - a[1] * b[1] - a[2] * b[2],
+            -a[0] * b[1] + a[1] * b[0] - a[3] * b[2],
+            -a[0] * b[2] + a[2] * b[0] + a[3] * b[1],
+            -a[1] * b[2] + a[2] * b[1] - a[3] * b[0],
+            -a[0] * b[3] + a[4] * b[0] + a[5] * b[1] + a[6] * b[2],
+            -a[1] * b[3] + a[4] * b[1] - a[5] * b[0] + a[7] * b[2],
+            -a[2] * b[3] + a[4] * b[2] - a[6] * b[0] - a[7] * b[1],
+            -a[3] * b[3] + a[5] * b[2] - a[6] * b[1] + a[7] * b[0],
+        };
+        return {odd_times_reverse<0, 1, 2, 4>(t)};
+    }
+
+    // M * l * ~M
+    constexpr Line apply(const Line &line) const {
+        const float *a = coefficients.data(), *b = line.coefficients.data();
+        // t = M * l, even
+        const float t[8] = {
+            a[1] * b[0] + a[2] * b[1] + a[3] * b[2],
+            -a[0] * b[0] + a[2] * b[2] - a[3] * b[1],
+            -a[0] * b[1] - a[1] * b[2] + a[3] * b[0],
+            -a[0] * b[2] + a[1] * b[1] - a[2] * b[0],
+            -a[0] * b[3] - a[1] * b[4] - a[2] * b[5] + a[5] * b[0] + a[6] * b[1] + a[7] * b[2],
+            -a[0] * b[4] + a[1] * b[3] - a[3] * b[5] - a[4] * b[0] + a[6] * b[2] - a[7] * b[1],
+            -a[0] * b[5] + a[2] * b[3] + a[3] * b[4] - a[4] * b[1] - a[5] * b[2] + a[7] * b[0],
+            -a[1] * b[5] + a[2] * b[4] - a[3] * b[3] - a[4] * b[2] + a[5] * b[1] - a[6] * b[0],
+        };
+        return {odd_times_reverse<1, 2, 3, 4, 5, 6>(t)};
+    }
+
+    // M / sqrt(M * ~M). M * ~M is a dual number s + p * e(15), whose inverse
+    // square root is s^(-1/2) * (1 - p / (2 s) * e(15)).
+    Motor normalize() const {
+        const float *a = coefficients.data();
+        float s = a[0] * a[0] + a[1] * a[1] + a[2] * a[2] + a[3] * a[3];
+        float p = 2.0f * (-a[0] * a[7] + a[1] * a[6] - a[2] * a[5] + a[3] * a[4]);
+        float inverse = 1.0f / std::sqrt(s);
+        return *this * dual(inverse, -p * inverse / (2.0f * s));
+    }
+
+    // exp(B) for a line B in closed form. B * B = -(l + d e(15))^2 with l the
+    // length of the euclidean part, so exp(B) = cos(l + d e(15)) + sinc-scaled B
+    // evaluated in dual numbers.
+    static Motor exp(const Line &line) {
+        const float *b = line.coefficients.data();
+        float l = std::sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+        float m = 2.0f * (-b[0] * b[5] + b[1] * b[4] - b[2] * b[3]);
+        float sinc = 1.0f, k1 = m / 6.0f;
+        if (l > 1e-4f) {
+            sinc = std::sin(l) / l;
+            k1 = -m * (std::cos(l) - sinc) / (2.0f * l * l);
+        }
+        Motor bivector{{0.0f, b[0], b[1], b[2], b[3], b[4], b[5], 0.0f}};
+        Motor result = bivector * dual(sinc, k1);
+        result.coefficients[0] -= std::cos(l);
+        result.coefficients[7] += m * sinc / 2.0f;
+        return result;
+    }
+
+    // Inverse of exp() for a normalized motor.
+    Line log() const {
+        const float *a = coefficients.data();
+        float c0 = -a[0], c1 = a[7];
+        float w = std::sqrt(a[1] * a[1] + a[2] * a[2] + a[3] * a[3]);
+        float v = 2.0f * (-a[1] * a[6] + a[2] * a[5] - a[3] * a[4]);
+        // log M = L / sin(L) * W for the dual angle L = atan2(sin L, cos L).
+        float f0, f1;
+        if (w > 1e-4f) {
+            float s0 = w, s1 = -v / (2.0f * w);
+            float l0 = std::atan2(s0, c0), l1 = (c0 * s1 - s0 * c1) / (s0 * s0 + c0 * c0);
+            f0 = l0 / s0;
+            f1 = (l1 * s0 - l0 * s1) / (s0 * s0);
+        } else {
+            f0 = 1.0f / c0;
+            f1 = -c1 / (c0 * c0);
+        }
+        Motor bivector{{0.0f, a[1], a[2], a[3], a[4], a[5], a[6], 0.0f}};
+        Motor result = bivector * dual(f0, f1);
+        const float *r = result.coefficients.data();
+        return {{r[1], r[2], r[3], r[4], r[5], r[6]}};
+    }
+
+    // from * exp(t * log(~from * to)) for normalized motors.
+    static Motor interpolate(const Motor &from, const Motor &to, float t) {
+        Line l = (~from * to).log();
+        return from * exp(l * t);
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const Motor &m) {
+        return os << m.to_multivector();
+    }
+
+private:
+    // x + y * e(15) in true scalars.
+    static constexpr Motor dual(float x, float y) {
+        return {{-x, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, y}};
+    }
+
+    // Selected components of t * ~M; t holds an odd or even multivector in
+    // ascending mask order, which share the same product table with M.
+    template <size_t... Out>
+    constexpr std::array<float, sizeof...(Out)> odd_times_reverse(const float *a) const {
+        const Motor r = reverse();
+        const float *b = r.coefficients.data();
+        const float full[8] = {
+            -a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3],
+            -a[0] * b[1] - a[1] * b[0] + a[2] * b[3] - a[3] * b[2],
+            -a[0] * b[2] - a[1] * b[3] - a[2] * b[0] + a[3] * b[1],
+            -a[0] * b[3] + a[1] * b[2] - a[2] * b[1] - a[3] * b[0],
+            -a[0] * b[4] - a[1] * b[5] - a[2] * b[6] + a[3] * b[7] - a[4] * b[0] + a[5] * b[1] + a[6] * b[2] + a[7] * b[3],
+            -a[0] * b[5] + a[1] * b[4] - a[2] * b[7] - a[3] * b[6] - a[4] * b[1] - a[5] * b[0] + a[6] * b[3] - a[7] * b[2],
+            -a[0] * b[6] + a[1] * b[7] + a[2] * b[4] + a[3] * b[5] - a[4] * b[2] - a[5] * b[3] - a[6] * b[0] + a[7] * b[1],
+            -a[0] * b[7] - a[1] * b[6] + a[2] * b[5] - a[3] * b[4] - a[4] * b[3] + a[5] * b[2] - a[6] * b[1] - a[7] * b[0],
+        };
+        return {full[Out]...};
+    }
+};
+
+/**
+ * Vector of conformal geometric algebra (4,1) in the null basis.
+ *
+ * Coefficients are e(1) e(2) e(4), origin and infinity, with
+ * origin = (e(16) - e(8)) / 2 and infinity = e(16) + e(8) in the diagonal
+ * basis of ConformalSignature. Points, dual spheres and dual planes are all
+ * vectors, and in this basis they keep a zero or implied coefficient instead
+ * of spreading over both e(8) and e(16).
+ */
+struct ConformalVector {
+    using Diagonal = StaticMultivector<ConformalSignature, 1, 2, 4, 8, 16>;
+
+    std::array<float, 5> coefficients{};
+
+    // x + x^2 / 2 infinity + origin
+    static constexpr ConformalVector point(float x, float y, float z) {
+        return {{x, y, z, 1.0f, 0.5f * (x * x + y * y + z * z)}};
+    }
+
+    // Dual sphere C - r^2 / 2 infinity around the point C.
+    static constexpr ConformalVector sphere(float x, float y, float z, float radius) {
+        ConformalVector s = point(x, y, z);
+        s.coefficients[4] -= 0.5f * radius * radius;
+        return s;
+    }
+
+    // Dual plane n + d infinity: the points x with x . n == d for unit n.
+    static constexpr ConformalVector plane(float nx, float ny, float nz, float distance) {
+        return {{nx, ny, nz, 0.0f, distance}};
+    }
+
+    // Every blade of v must be a vector.
+    static ConformalVector from(const ConformalMultivector &v) {
+        return from(Diagonal::from(v));
+    }
+
+    static constexpr ConformalVector from(const Diagonal &d) {
+        const auto &c = d.coefficients;
+        return {{c[0], c[1], c[2], c[4] - c[3], 0.5f * (c[3] + c[4])}};
+    }
+
+    constexpr Diagonal diagonal() const {
+        const auto &c = coefficients;
+        return {{c[0], c[1], c[2], c[4] - 0.5f * c[3], c[4] + 0.5f * c[3]}};
+    }
+
+    ConformalMultivector to_multivector() const {
+        return diagonal().to_multivector();
+    }
+
+    // Inner product; origin and infinity are null with origin . infinity == -1.
+    // For points it is -|x - y|^2 / 2, for a point and a dual sphere
+    // (r^2 - |x - c|^2) / 2, for a point and a dual plane x . n - d.
+    constexpr float dot(const ConformalVector &other) const {
+        const auto &a = coefficients, &b = other.coefficients;
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] - a[3] * b[4] - a[4] * b[3];
+    }
+
+    // Rescales a point or dual sphere to unit origin coefficient.
+    constexpr ConformalVector normalize() const {
+        ConformalVector result = *this;
+        for (float &c : result.coefficients) {
+            c /= coefficients[3];
+        }
+        return result;
+    }
+};
+
+/**
+ * Conformal versor applied as a linear map on null-basis vectors.
+ *
+ * from() evaluates V * x * ~V / (V * ~V) once per basis vector, so applying
+ * the transform to a point, sphere or plane costs a 5x5 matrix product
+ * instead of two 32-blade products, and composition multiplies the maps.
+ */
+class ConformalTransform {
+public:
+    static constexpr ConformalTransform identity() {
+        ConformalTransform t;
+        for (size_t i = 0; i < 5; i++) {
+            t.m_matrix[i * 5 + i] = 1.0f;
+        }
+        return t;
+    }
+
+    static ConformalTransform from(const ConformalMultivector &versor) {
+        const ConformalMultivector reversed = ~versor;
+        const ConformalMultivector squared = versor * reversed;
+        float norm = 0.0f;
+        for (const auto &b : squared.blades()) {
+            if (b.mask == 0) {
+                // e(0) is minus the identity.
+                norm = -b.coefficient;
+            }
+        }
+        assert(norm != 0.0f && "Versor must be invertible");
+
+        ConformalTransform t;
+        for (size_t j = 0; j < 5; j++) {
+            ConformalVector basis{};
+            basis.coefficients[j] = 1.0f;
+            const ConformalMultivector image = versor * basis.to_multivector() * reversed;
+
+            ConformalVector::Diagonal diagonal;
+            for (const auto &b : image.blades()) {
+                size_t i = std::find(diagonal.masks.begin(), diagonal.masks.end(), b.mask) - diagonal.masks.begin();
+                if (i < diagonal.size) {
+                    diagonal.coefficients[i] = b.coefficient / norm;
+                }
+            }
+            const ConformalVector column = ConformalVector::from(diagonal);
+            for (size_t i = 0; i < 5; i++) {
+                t.m_matrix[i * 5 + j] = column.coefficients[i];
+            }
+        }
+        return t;
+    }
+
+    // Translation by t: 1 - t infinity / 2, in closed form.
+    static constexpr ConformalTransform translator(float x, float y, float z) {
+        ConformalTransform t = identity();
+        const float offset[3] = {x, y, z};
+        for (size_t i = 0; i < 3; i++) {
+            t.m_matrix[i * 5 + 3] = offset[i];
+            t.m_matrix[4 * 5 + i] = offset[i];
+        }
+        t.m_matrix[4 * 5 + 3] = 0.5f * (x * x + y * y + z * z);
+        return t;
+    }
+
+    constexpr ConformalVector apply(const ConformalVector &v) const {
+        ConformalVector result{};
+        for (size_t i = 0; i < 5; i++) {
+            float sum = 0.0f;
+            for (size_t j = 0; j < 5; j++) {
+                sum += m_matrix[i * 5 + j] * v.coefficients[j];
+            }
+            result.coefficients[i] = sum;
+        }
+        return result;
+    }
+
+    void apply(std::span<ConformalVector> vectors) const {
+        for (auto &v : vectors) {
+            v = apply(v);
+        }
+    }
+
+    // Applies other first, then this.
+    constexpr ConformalTransform operator*(const ConformalTransform &other) const {
+        ConformalTransform result;
+        for (size_t i = 0; i < 5; i++) {
+            for (size_t j = 0; j < 5; j++) {
+                float sum = 0.0f;
+                for (size_t k = 0; k < 5; k++) {
+                    sum += m_matrix[i * 5 + k] * other.m_matrix[k * 5 + j];
+                }
+                result.m_matrix[i * 5 + j] = sum;
+            }
+        }
+        return result;
+    }
+
+private:
+    std::array<float, 25> m_matrix{};
+};
+
+/**
+ * Accumulation policies for AccumulatedProduct and Multivector::sum.
+ *
+ * FloatAccumulator matches operator*. DoubleAccumulator sums exact float
+ * products in double. CompensatedAccumulator stays in float registers: each
+ * product is split into its rounded value and exact error with fma, and both
+ * are summed with Neumaier's compensated summation.
+ */
+struct FloatAccumulator {
+    float sum = 0.0f;
+
+    void add(float x) {
+        sum += x;
+    }
+
+    void add_product(float a, float b) {
+        sum += a * b;
+    }
+
+    float value() const {
+        return sum;
+    }
+};
+
+struct DoubleAccumulator {
+    double sum = 0.0;
+
+    void add(float x) {
+        sum += x;
+    }
+
+    void add_product(float a, float b) {
+        sum += static_cast<double>(a) * static_cast<double>(b);
+    }
+
+    float value() const {
+        return static_cast<float>(sum);
+    }
+};
+
+struct CompensatedAccumulator {
+    float sum = 0.0f;
+    float compensation = 0.0f;
+
+    void add(float x) {
+        float t = sum + x;
+        if (std::fabs(sum) >= std::fabs(x)) {
+            compensation += (sum - t) + x;
+        } else {
+            compensation += (x - t) + sum;
+        }
+        sum = t;
+    }
+
+    void add_product(float a, float b) {
+        float p = a * b;
+        add(p);
+        compensation += std::fma(a, b, -p);
+    }
+
+    float value() const {
+        return sum + compensation;
+    }
+};
+
+/**
+ * Geometric product that keeps float storage but accumulates every output
+ * blade with Accumulator, rounding to float once at the end. Output blades
+ * appear in the same order as with operator*.
+ */
+template <class Accumulator>
+struct AccumulatedProduct {
+    template <class Signature>
+    static Multivector<Signature> multiply(const Multivector<Signature> &A, const Multivector<Signature> &B) {
+        using V = Multivector<Signature>;
+        Accumulation accumulation;
+        for (const auto &a : A.blades()) {
+            for (const auto &b : B.blades()) {
+                float signed_a = V::sign(a.mask, b.mask) * a.coefficient;
+                if (signed_a * b.coefficient != 0.0f) {
+                    accumulation.at(a.mask ^ b.mask).add_product(signed_a, b.coefficient);
+                }
+            }
+        }
+        return accumulation.template result<Signature>();
+    }
+
+    template <class Signature>
+    static Multivector<Signature> accumulate(std::span<const Multivector<Signature>> terms) {
+        Accumulation accumulation;
+        for (const auto &term : terms) {
+            for (const auto &b : term.blades()) {
+                if (b.coefficient != 0.0f) {
+                    accumulation.at(b.mask).add(b.coefficient);
+                }
+            }
+        }
+        return accumulation.template result<Signature>();
+    }
+
+private:
+    struct Accumulation {
+        std::unordered_map<uint64_t, size_t> index;
+        std::vector<uint64_t> masks;
+        std::vector<Accumulator> accumulators;
+
+        Accumulator &at(uint64_t mask) {
+            auto [it, inserted] = index.try_emplace(mask, masks.size());
+            if (inserted) {
+                masks.push_back(mask);
+                accumulators.emplace_back();
+            }
+            return accumulators[it->second];
+        }
+
+        template <class Signature>
+        Multivector<Signature> result() const {
+            Multivector<Signature> v;
+            v.reserve(masks.size());
+            for (size_t i = 0; i < masks.size(); i++) {
+                v.push_blade(accumulators[i].value(), masks[i]);
+            }
+            return v;
+        }
+    };
+};
+
+/**
+ * Structure-of-arrays batch of multivectors that share one blade set.
+ *
+ * Coefficient column k holds the coefficient of masks()[k] for every element,
+ * so per-blade loops over the batch are contiguous and vectorize.
+ */
+template <class Signature>
+class MultivectorBatch {
+public:
+    explicit MultivectorBatch(std::vector<uint64_t> masks) : m_masks(std::move(masks)), m_columns(m_masks.size()) {}
+
+    // Batch over the union of the blade sets of `items`.
+    static MultivectorBatch from(std::span<const Multivector<Signature>> items) {
+        std::vector<uint64_t> masks;
+        for (const auto &v : items) {
+            for (const auto &b : v.blades()) {
+                if (std::find(masks.begin(), masks.end(), b.mask) == masks.end()) {
+                    masks.push_back(b.mask);
+                }
+            }
+        }
+        MultivectorBatch batch(std::move(masks));
+        for (const auto &v : items) {
+            batch.push_back(v);
+        }
+        return batch;
+    }
+
+    size_t size() const {
+        return m_count;
+    }
+
+    const std::vector<uint64_t> &masks() const {
+        return m_masks;
+    }
+
+    float *column(size_t blade) {
+        return m_columns[blade].data();
+    }
+
+    const float *column(size_t blade) const {
+        return m_columns[blade].data();
+    }
+
+    // Every blade of v must belong to the batch's blade set; otherwise this
+    // throws std::out_of_range and leaves the batch unchanged.
+    void push_back(const Multivector<Signature> &v) {
+        for (const auto &b : v.blades()) {
+            column_index(b.mask);
+        }
+        for (auto &c : m_columns) {
+            c.push_back(0.0f);
+        }
+        m_count++;
+        set(m_count - 1, v);
+    }
+
+    void set(size_t i, const Multivector<Signature> &v) {
+        check_row(i);
+        for (const auto &b : v.blades()) {
+            column_index(b.mask);
+        }
+        for (auto &c : m_columns) {
+            c[i] = 0.0f;
+        }
+        for (const auto &b : v.blades()) {
+            m_columns[column_index(b.mask)][i] += b.coefficient;
+        }
+    }
+
+    Multivector<Signature> operator[](size_t i) const {
+        check_row(i);
+        Multivector<Signature> v;
+        for (size_t k = 0; k < m_masks.size(); k++) {
+            v.add_blade(m_columns[k][i], m_masks[k]);
+        }
+        return v;
+    }
+
+    // Elementwise Multivector::norm2(), one column at a time.
+    std::vector<float> norm2() const {
+        using V = Multivector<Signature>;
+        std::vector<float> result(m_count, 0.0f);
+        for (size_t k = 0; k < m_masks.size(); k++) {
+            const float w = V::versor_weight(m_masks[k], m_masks[k]);
+            const float *c = column(k);
+            for (size_t i = 0; i < m_count; i++) {
+                result[i] += w * c[i] * c[i];
+            }
+        }
+        return result;
+    }
+
+    std::vector<float> norm() const {
+        std::vector<float> result = norm2();
+        for (float &x : result) {
+            x = std::sqrt(std::fabs(x));
+        }
+        return result;
+    }
+
+    // Elementwise Multivector::scalar_product(A[i], B[i]); only the columns of
+    // masks the two blade sets share contribute.
+    static std::vector<float> scalar_product(const MultivectorBatch &A, const MultivectorBatch &B) {
+        using V = Multivector<Signature>;
+        assert(A.size() == B.size() && "Batch sizes differ");
+        std::vector<float> result(A.size(), 0.0f);
+        for (size_t k = 0; k < A.m_masks.size(); k++) {
+            const size_t l = std::find(B.m_masks.begin(), B.m_masks.end(), A.m_masks[k]) - B.m_masks.begin();
+            if (l == B.m_masks.size()) {
+                continue;
+            }
+            const float w = static_cast<float>(V::sign(A.m_masks[k], A.m_masks[k]));
+            const float *a = A.column(k), *b = B.column(l);
+            for (size_t i = 0; i < result.size(); i++) {
+                result[i] += w * a[i] * b[i];
+            }
+        }
+        return result;
+    }
+
+    // Batched Multivector::normalize(). The pseudoscalar correction is applied
+    // in 4D when the blade set is closed under multiplication by e(I), which
+    // holds for even (rotor) blade sets. Both paths take their inverse square
+    // roots from the vectorized rsqrt kernel.
+    void normalize() {
+        using V = Multivector<Signature>;
+        MULTIVECTOR_TRACE_SPAN(span, "MultivectorBatch::normalize", m_count, 0);
+        std::vector<float> scalar = norm2(), pseudoscalar(m_count, 0.0f);
+
+        const std::vector<size_t> partner = pseudoscalar_partners();
+        if (partner.empty()) {
+            for (size_t i = 0; i < m_count; i++) {
+                scalar[i] = std::fabs(scalar[i]);
+            }
+            rsqrt(scalar.data(), m_count);
+            for (size_t k = 0; k < m_masks.size(); k++) {
+                float *c = column(k);
+                for (size_t i = 0; i < m_count; i++) {
+                    c[i] *= scalar[i];
+                }
+            }
+            return;
+        }
+
+        const uint64_t I = V::pseudoscalar_mask();
+        for (size_t k = 0; k < m_masks.size(); k++) {
+            const float w = V::versor_weight(m_masks[k], m_masks[partner[k]]);
+            const float *c = column(k), *d = column(partner[k]);
+            for (size_t i = 0; i < m_count; i++) {
+                pseudoscalar[i] += w * c[i] * d[i];
+            }
+        }
+        std::vector<float> &alpha = scalar, &beta = pseudoscalar;
+        inverse_sqrt(alpha.data(), beta.data(), m_count);
+        // c'_k = alpha c_k + beta sign(partner, I) c_partner, i.e. R * (alpha + beta I).
+        std::vector<std::vector<float>> result(m_masks.size(), std::vector<float>(m_count));
+        for (size_t k = 0; k < m_masks.size(); k++) {
+            const float s = static_cast<float>(V::sign(m_masks[partner[k]], I));
+            const float *c = column(k), *d = column(partner[k]);
+            for (size_t i = 0; i < m_count; i++) {
+                result[k][i] = alpha[i] * c[i] + beta[i] * s * d[i];
+            }
+        }
+        m_columns = std::move(result);
+    }
+
+    // Elementwise Multivector::interpolate(from[i], to[i], t[i]). The terms of
+    // ~from * to and of from * B are resolved once for the blade sets and then
+    // run column by column; in 4D the pseudoscalar terms are carried along too.
+    // Throws std::domain_error like Multivector::interpolate for a non-simple
+    // relative rotor outside 4D.
+    static MultivectorBatch interpolate(const MultivectorBatch &from, const MultivectorBatch &to,
+                                        std::span<const float> t) {
+        using V = Multivector<Signature>;
+        assert(from.size() == to.size() && t.size() == from.size() && "Batch sizes differ");
+        MULTIVECTOR_TRACE_SPAN(span, "MultivectorBatch::interpolate", from.size(), to.size());
+        const size_t n = from.size();
+
+        constexpr bool four_dimensional = Signature::max_dimension() == 4;
+        const uint64_t I = V::pseudoscalar_mask();
+        std::vector<float> scalar(n, 0.0f), pseudoscalar(n, 0.0f);
+        std::vector<uint64_t> bivector_masks, higher_masks;
+        std::vector<std::vector<float>> bivector, higher;
+        auto column_for = [n](std::vector<uint64_t> &masks, std::vector<std::vector<float>> &columns, uint64_t mask) {
+            size_t j = std::find(masks.begin(), masks.end(), mask) - masks.begin();
+            if (j == masks.size()) {
+                masks.push_back(mask);
+                columns.emplace_back(n, 0.0f);
+            }
+            return columns[j].data();
+        };
+        bool dual = false;
+        for (size_t k = 0; k < from.m_masks.size(); k++) {
+            for (size_t l = 0; l < to.m_masks.size(); l++) {
+                uint64_t mask = from.m_masks[k] ^ to.m_masks[l];
+                int grade = __builtin_popcountll(mask);
+                if (grade % 2 != 0) {
+                    continue;
+                }
+                float *out = scalar.data();
+                if (grade == 4 && four_dimensional) {
+                    out = pseudoscalar.data();
+                    dual = true;
+                } else if (grade >= 4) {
+                    out = column_for(higher_masks, higher, mask);
+                } else if (grade == 2) {
+                    out = column_for(bivector_masks, bivector, mask);
+                }
+                const float w = V::relative_weight(from.m_masks[k], to.m_masks[l]);
+                const float *a = from.column(k), *b = to.column(l);
+                for (size_t i = 0; i < n; i++) {
+                    out[i] += w * a[i] * b[i];
+                }
+            }
+        }
+
+        if (!higher.empty()) {
+            for (size_t i = 0; i < n; i++) {
+                float total = scalar[i] * scalar[i], excess = 0.0f;
+                for (const auto &b : bivector) {
+                    total += b[i] * b[i];
+                }
+                for (const auto &h : higher) {
+                    excess += h[i] * h[i];
+                }
+                if (excess > V::simple_tolerance * V::simple_tolerance * (total + excess)) {
+                    throw std::domain_error("Rotors must be simple outside 4D");
+                }
+            }
+        }
+
+        std::vector<float> square(n, 0.0f), square_pseudoscalar(n, 0.0f);
+        for (size_t j = 0; j < bivector_masks.size(); j++) {
+            const float w = static_cast<float>(-V::sign(bivector_masks[j], bivector_masks[j]));
+            for (size_t i = 0; i < n; i++) {
+                square[i] += w * bivector[j][i] * bivector[j][i];
+            }
+            for (size_t l = 0; four_dimensional && l < bivector_masks.size(); l++) {
+                if ((bivector_masks[j] ^ bivector_masks[l]) != I) {
+                    continue;
+                }
+                dual = true;
+                const float v = static_cast<float>(V::sign(bivector_masks[j], bivector_masks[l]));
+                for (size_t i = 0; i < n; i++) {
+                    square_pseudoscalar[i] += v * bivector[j][i] * bivector[l][i];
+                }
+            }
+        }
+        std::vector<float> c(n), c_pseudoscalar(n, 0.0f), k(n), k_pseudoscalar(n, 0.0f);
+        for (size_t i = 0; i < n; i++) {
+            if (dual) {
+                const auto power = V::rotor_power(-scalar[i], pseudoscalar[i], square[i], square_pseudoscalar[i], t[i]);
+                c[i] = power[0];
+                c_pseudoscalar[i] = power[1];
+                k[i] = power[2];
+                k_pseudoscalar[i] = power[3];
+            } else {
+                std::tie(c[i], k[i]) = V::rotor_power(-scalar[i], square[i], t[i]);
+            }
+        }
+
+        // from * (c + c' I) + (from * B) * (k + k' I); the I terms only appear in 4D.
+        std::vector<uint64_t> masks = from.m_masks;
+        auto add_mask = [&](uint64_t mask) {
+            if (std::find(masks.begin(), masks.end(), mask) == masks.end()) {
+                masks.push_back(mask);
+            }
+        };
+        for (uint64_t f : from.m_masks) {
+            for (uint64_t b : bivector_masks) {
+                add_mask(f ^ b);
+                if (dual) {
+                    add_mask(f ^ b ^ I);
+                }
+            }
+            if (dual) {
+                add_mask(f ^ I);
+            }
+        }
+        MultivectorBatch result(masks);
+        for (auto &column : result.m_columns) {
+            column.assign(n, 0.0f);
+        }
+        result.m_count = n;
+        auto column_of = [&](uint64_t mask) {
+            return result.column(std::find(masks.begin(), masks.end(), mask) - masks.begin());
+        };
+        for (size_t f = 0; f < from.m_masks.size(); f++) {
+            const uint64_t from_mask = from.m_masks[f];
+            const float *a = from.column(f);
+            float *out = result.column(f);
+            for (size_t i = 0; i < n; i++) {
+                out[i] += c[i] * a[i];
+            }
+            if (dual) {
+                float *dst = column_of(from_mask ^ I);
+                const float w = static_cast<float>(V::sign(from_mask, I));
+                for (size_t i = 0; i < n; i++) {
+                    dst[i] += w * c_pseudoscalar[i] * a[i];
+                }
+            }
+            for (size_t j = 0; j < bivector_masks.size(); j++) {
+                const uint64_t mask = from_mask ^ bivector_masks[j];
+                float *dst = column_of(mask);
+                const float w = static_cast<float>(V::sign(from_mask, bivector_masks[j]));
+                const float *b = bivector[j].data();
+                for (size_t i = 0; i < n; i++) {
+                    dst[i] += w * k[i] * a[i] * b[i];
+                }
+                if (dual) {
+                    float *dual_dst = column_of(mask ^ I);
+                    const float v = w * static_cast<float>(V::sign(mask, I));
+                    for (size_t i = 0; i < n; i++) {
+                        dual_dst[i] += v * k_pseudoscalar[i] * a[i] * b[i];
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    // Keyframe i sits at time i; each sample interpolates between its neighbouring keyframes.
+    MultivectorBatch sample(std::span<const float> times) const {
+        assert(m_count > 0 && "No keyframes");
+        MultivectorBatch from(m_masks), to(m_masks);
+        std::vector<float> t(times.size());
+        for (size_t k = 0; k < m_masks.size(); k++) {
+            from.m_columns[k].resize(times.size());
+            to.m_columns[k].resize(times.size());
+        }
+        from.m_count = to.m_count = times.size();
+        for (size_t i = 0; i < times.size(); i++) {
+            float clamped = std::clamp(times[i], 0.0f, static_cast<float>(m_count - 1));
+            size_t key = std::min(static_cast<size_t>(clamped), m_count > 1 ? m_count - 2 : 0);
+            size_t next = std::min(key + 1, m_count - 1);
+            t[i] = clamped - static_cast<float>(key);
+            for (size_t k = 0; k < m_masks.size(); k++) {
+                from.m_columns[k][i] = m_columns[k][key];
+                to.m_columns[k][i] = m_columns[k][next];
+            }
+        }
+        return interpolate(from, to, t);
+    }
+
+private:
+    void check_row(size_t i) const {
+        if (i >= m_count) {
+            throw std::out_of_range("Batch index out of range");
+        }
+    }
+
+    size_t column_index(uint64_t mask) const {
+        const size_t k = std::find(m_masks.begin(), m_masks.end(), mask) - m_masks.begin();
+        if (k == m_masks.size()) {
+            throw std::out_of_range("Blade outside of the batch blade set");
+        }
+        return k;
+    }
+
+    // Index of masks[k] ^ I for every k, or empty if that is not a 4D batch closed under it.
+    std::vector<size_t> pseudoscalar_partners() const {
+        if (Signature::max_dimension() != 4) {
+            return {};
+        }
+        const uint64_t I = Multivector<Signature>::pseudoscalar_mask();
+        std::vector<size_t> partner(m_masks.size());
+        for (size_t k = 0; k < m_masks.size(); k++) {
+            partner[k] = std::find(m_masks.begin(), m_masks.end(), m_masks[k] ^ I) - m_masks.begin();
+            if (partner[k] == m_masks.size()) {
+                return {};
+            }
+        }
+        return partner;
+    }
+
+    // Multivector::inverse_sqrt() over arrays: on entry the scalar and
+    // pseudoscalar parts of R * ~R, on exit alpha and beta. Each case of I * I
+    // reduces to inverse square roots of real numbers, which run through rsqrt;
+    // the remaining arithmetic is lane-wise.
+    static void inverse_sqrt(float *scalar, float *pseudoscalar, size_t n) {
+        using V = Multivector<Signature>;
+        const uint64_t I = V::pseudoscalar_mask();
+        const int32_t square = V::sign(I, I);
+        std::vector<float> x(n), y(n);
+        for (size_t i = 0; i < n; i++) {
+            // sigma + pi I with sigma = -scalar made non-negative.
+            const float flip = scalar[i] > 0.0f ? -1.0f : 1.0f;
+            scalar[i] *= -flip;
+            pseudoscalar[i] *= flip;
+        }
+        float *sigma = scalar, *pi = pseudoscalar;
+        if (square == 0) {
+            // I * I == 0: sigma^(-1/2) (1 - pi / (2 sigma) I).
+            std::copy(sigma, sigma + n, x.begin());
+            rsqrt(x.data(), n);
+            for (size_t i = 0; i < n; i++) {
+                sigma[i] = x[i];
+                pi[i] = -0.5f * pi[i] * x[i] * x[i] * x[i];
+            }
+        } else if (square > 0) {
+            // I * I == -1: with r = |sigma + pi I| and h = sqrt((r + sigma) / 2),
+            // the principal root is h + pi / (2 h) I, so its inverse is
+            // (h - pi / (2 h) I) / r.
+            for (size_t i = 0; i < n; i++) {
+                x[i] = sigma[i] * sigma[i] + pi[i] * pi[i];
+            }
+            rsqrt(x.data(), n);
+            for (size_t i = 0; i < n; i++) {
+                const float r = (sigma[i] * sigma[i] + pi[i] * pi[i]) * x[i];
+                y[i] = 0.5f * (r + sigma[i]);
+            }
+            rsqrt(y.data(), n);
+            for (size_t i = 0; i < n; i++) {
+                const float h_squared = 0.5f * ((sigma[i] * sigma[i] + pi[i] * pi[i]) * x[i] + sigma[i]);
+                sigma[i] = h_squared * y[i] * x[i];
+                pi[i] = -0.5f * pi[i] * y[i] * x[i];
+            }
+        } else {
+            // I * I == +1: through the idempotents (1 +- I) / 2.
+            for (size_t i = 0; i < n; i++) {
+                x[i] = sigma[i] + pi[i];
+                y[i] = std::fabs(sigma[i] - pi[i]);
+            }
+            rsqrt(x.data(), n);
+            rsqrt(y.data(), n);
+            for (size_t i = 0; i < n; i++) {
+                sigma[i] = 0.5f * (x[i] + y[i]);
+                pi[i] = 0.5f * (x[i] - y[i]);
+            }
+        }
+    }
+
+    // x[i] = 1 / sqrt(x[i]): hardware estimate refined by one Newton step.
+    static void rsqrt(float *x, size_t n) {
+        size_t i = 0;
+#if defined(__SSE__)
+        const __m128 half = _mm_set1_ps(0.5f), three = _mm_set1_ps(3.0f);
+        for (; i + 4 <= n; i += 4) {
+            __m128 v = _mm_loadu_ps(x + i);
+            __m128 y = _mm_rsqrt_ps(v);
+            // y * (3 - v * y * y) / 2
+            y = _mm_mul_ps(_mm_mul_ps(half, y), _mm_sub_ps(three, _mm_mul_ps(v, _mm_mul_ps(y, y))));
+            _mm_storeu_ps(x + i, y);
+        }
+#endif
+        for (; i < n; i++) {
+            x[i] = 1.0f / std::sqrt(x[i]);
+        }
+    }
+
+    std::vector<uint64_t> m_masks;
+    std::vector<std::vector<float>> m_columns;
+    size_t m_count = 0;
+};
+
+/**
+ * Lorentz transformation of spacetime multivectors.
+ *
+ * Holds the rotor R together with the linear maps x -> R * x * ~R it induces
+ * on 4-vectors (e(1) e(2) e(4) e(8), with e(1) the time axis) and on field
+ * bivectors (e(3) e(5) e(6) e(9) e(10) e(12)). The maps are built once, so
+ * transforming an array is a 4x4 or 6x6 matrix product per element rather
+ * than two general products.
+ */
+class LorentzTransform {
+public:
+    using Vector = std::array<float, 4>;
+    using Bivector = std::array<float, 6>;
+
+    static constexpr std::array<uint64_t, 4> vector_masks = {1, 2, 4, 8};
+    static constexpr std::array<uint64_t, 6> bivector_masks = {3, 5, 6, 9, 10, 12};
+
+    static LorentzTransform identity() {
+        return LorentzTransform(SpacetimeMultivector::create({{-1.0f, 0}}));
+    }
+
+    // Boost with the given rapidity along the spatial axis (x, y, z): the
+    // time axis maps to cosh(rapidity) e(1) + sinh(rapidity) * axis.
+    static LorentzTransform boost(float rapidity, float x, float y, float z) {
+        return LorentzTransform(exponential(SpacetimeMultivector::basis_vector(0) * spatial(x, y, z), rapidity / 2));
+    }
+
+    // Right-handed rotation by angle about the spatial axis (x, y, z).
+    static LorentzTransform rotation(float angle, float x, float y, float z) {
+        const SpacetimeMultivector e2 = SpacetimeMultivector::basis_vector(1);
+        const SpacetimeMultivector e4 = SpacetimeMultivector::basis_vector(2);
+        const SpacetimeMultivector e8 = SpacetimeMultivector::basis_vector(3);
+        // Plane dual to the unit axis within space.
+        const std::array<float, 3> axis = unit_axis(x, y, z);
+        const SpacetimeMultivector plane = axis[0] * (e4 * e8) + axis[1] * (e8 * e2) + axis[2] * (e2 * e4);
+        return LorentzTransform(exponential(plane, -angle / 2));
+    }
+
+    // R must be a normalized rotor, R * ~R == 1.
+    static LorentzTransform from(const SpacetimeMultivector &rotor) {
+        return LorentzTransform(rotor);
+    }
+
+    const SpacetimeMultivector &rotor() const {
+        return m_rotor;
+    }
+
+    // Applies other first, then this. The product is renormalized so that long
+    // chains of compositions do not drift away from R * ~R == 1.
+    LorentzTransform operator*(const LorentzTransform &other) const {
+        return LorentzTransform((m_rotor * other.m_rotor).normalize());
+    }
+
+    LorentzTransform inverse() const {
+        return LorentzTransform(~m_rotor);
+    }
+
+    Vector apply(const Vector &v) const {
+        Vector result{};
+        for (size_t i = 0; i < 4; i++) {
+            for (size_t j = 0; j < 4; j++) {
+                result[i] += m_vector[i * 4 + j] * v[j];
+            }
+        }
+        return result;
+    }
+
+    Bivector apply(const Bivector &b) const {
+        Bivector result{};
+        for (size_t i = 0; i < 6; i++) {
+            for (size_t j = 0; j < 6; j++) {
+                result[i] += m_bivector[i * 6 + j] * b[j];
+            }
+        }
+        return result;
+    }
+
+    void apply(std::span<Vector> vectors) const {
+        MULTIVECTOR_TRACE_SPAN(span, "LorentzTransform::apply", vectors.size(), 0);
+        size_t k = 0;
+#if defined(__SSE__)
+        // Sum of the matrix columns scaled by the components.
+        __m128 column[4];
+        for (size_t j = 0; j < 4; j++) {
+            column[j] = _mm_setr_ps(m_vector[j], m_vector[4 + j], m_vector[8 + j], m_vector[12 + j]);
+        }
+        for (; k < vectors.size(); k++) {
+            float *v = vectors[k].data();
+            __m128 r = _mm_mul_ps(column[0], _mm_set1_ps(v[0]));
+            r = _mm_add_ps(r, _mm_mul_ps(column[1], _mm_set1_ps(v[1])));
+            r = _mm_add_ps(r, _mm_mul_ps(column[2], _mm_set1_ps(v[2])));
+            r = _mm_add_ps(r, _mm_mul_ps(column[3], _mm_set1_ps(v[3])));
+            _mm_storeu_ps(v, r);
+        }
+#endif
+        for (; k < vectors.size(); k++) {
+            vectors[k] = apply(vectors[k]);
+        }
+    }
+
+    void apply(std::span<Bivector> bivectors) const {
+        MULTIVECTOR_TRACE_SPAN(span, "LorentzTransform::apply", bivectors.size(), 0);
+        size_t k = 0;
+#if defined(__SSE__)
+        // As for vectors, with rows 0-3 in one register and rows 4-5 in the low half of another.
+        __m128 low[6], high[6];
+        for (size_t j = 0; j < 6; j++) {
+            low[j] = _mm_setr_ps(m_bivector[j], m_bivector[6 + j], m_bivector[12 + j], m_bivector[18 + j]);
+            high[j] = _mm_setr_ps(m_bivector[24 + j], m_bivector[30 + j], 0.0f, 0.0f);
+        }
+        for (; k < bivectors.size(); k++) {
+            float *b = bivectors[k].data();
+            __m128 r = _mm_setzero_ps(), s = _mm_setzero_ps();
+            for (size_t j = 0; j < 6; j++) {
+                const __m128 x = _mm_set1_ps(b[j]);
+                r = _mm_add_ps(r, _mm_mul_ps(low[j], x));
+                s = _mm_add_ps(s, _mm_mul_ps(high[j], x));
+            }
+            _mm_storeu_ps(b, r);
+            _mm_storel_pi(reinterpret_cast<__m64 *>(b + 4), s);
+        }
+#endif
+        for (; k < bivectors.size(); k++) {
+            bivectors[k] = apply(bivectors[k]);
+        }
+    }
+
+    // Transforms the vector and bivector columns of a batch in place; each of
+    // those grades must be either absent or complete. Scalars and
+    // pseudoscalars are invariant.
+    void apply(MultivectorBatch<MinkowskiSignature> &batch) const {
+        MULTIVECTOR_TRACE_SPAN(span, "LorentzTransform::apply", batch.size(), 0);
+        apply_columns(batch, vector_masks, m_vector.data());
+        apply_columns(batch, bivector_masks, m_bivector.data());
+    }
+
+private:
+    explicit LorentzTransform(const SpacetimeMultivector &rotor) : m_rotor(rotor) {
+        // R * ~R == 1, whose e(0) part is -1 since e(0) is minus the identity. Large
+        // boosts cancel large terms there, so the tolerance scales with them.
+        assert(std::fabs(m_rotor.norm2() + 1.0f) < 1e-3f * magnitude(m_rotor) && "Lorentz rotor must be normalized");
+        const SpacetimeMultivector reversed = ~m_rotor;
+        build(vector_masks, reversed, m_vector.data());
+        build(bivector_masks, reversed, m_bivector.data());
+    }
+
+    // Sum of the squared coefficients, at least 1.
+    static float magnitude(const SpacetimeMultivector &v) {
+        float sum = 0.0f;
+        for (const auto &b : v.blades()) {
+            sum += b.coefficient * b.coefficient;
+        }
+        return std::max(sum, 1.0f);
+    }
+
+    static std::array<float, 3> unit_axis(float x, float y, float z) {
+        float length = std::sqrt(x * x + y * y + z * z);
+        assert(length > 0.0f && "Axis must be non-zero");
+        return {x / length, y / length, z / length};
+    }
+
+    static SpacetimeMultivector spatial(float x, float y, float z) {
+        const std::array<float, 3> axis = unit_axis(x, y, z);
+        return axis[0] * SpacetimeMultivector::basis_vector(1) +
+               axis[1] * SpacetimeMultivector::basis_vector(2) +
+               axis[2] * SpacetimeMultivector::basis_vector(3);
+    }
+
+    // exp(t * B) for a unit simple bivector B; boosts square to +1, rotations to -1.
+    static SpacetimeMultivector exponential(const SpacetimeMultivector &plane, float t) {
+        const SpacetimeMultivector squared = plane * plane;
+        float square = 0.0f;
+        for (const auto &b : squared.blades()) {
+            if (b.mask == 0) {
+                square = -b.coefficient;
+            }
+        }
+        const bool hyperbolic = square > 0.0f;
+        const float c = hyperbolic ? std::cosh(t) : std::cos(t);
+        const float s = hyperbolic ? std::sinh(t) : std::sin(t);
+        return SpacetimeMultivector::create({{-c, 0}}) + plane * s;
+    }
+
+    // Column j of the map holds the image of masks[j].
+    template <size_t N>
+    void build(const std::array<uint64_t, N> &masks, const SpacetimeMultivector &reversed, float *matrix) const {
+        for (size_t j = 0; j < N; j++) {
+            const SpacetimeMultivector image = m_rotor * SpacetimeMultivector::create({{1.0f, masks[j]}}) * reversed;
+            for (size_t i = 0; i < N; i++) {
+                matrix[i * N + j] = 0.0f;
+            }
+            for (const auto &b : image.blades()) {
+                size_t i = std::find(masks.begin(), masks.end(), b.mask) - masks.begin();
+                if (i < N) {
+                    matrix[i * N + j] += b.coefficient;
+                }
+            }
+        }
+    }
+
+    template <size_t N>
+    static void apply_columns(MultivectorBatch<MinkowskiSignature> &batch, const std::array<uint64_t, N> &masks,
+                              const float *matrix) {
+        std::array<size_t, N> index;
+        size_t found = 0;
+        for (size_t j = 0; j < N; j++) {
+            index[j] = std::find(batch.masks().begin(), batch.masks().end(), masks[j]) - batch.masks().begin();
+            found += index[j] < batch.masks().size();
+        }
+        if (found == 0) {
+            return;
+        }
+        assert(found == N && "Batch holds a partial grade");
+
+        const size_t n = batch.size();
+        std::vector<float> result(N * n, 0.0f);
+        for (size_t i = 0; i < N; i++) {
+            float *out = result.data() + i * n;
+            for (size_t j = 0; j < N; j++) {
+                const float m = matrix[i * N + j];
+                const float *in = batch.column(index[j]);
+                for (size_t k = 0; k < n; k++) {
+                    out[k] += m * in[k];
+                }
+            }
+        }
+        for (size_t i = 0; i < N; i++) {
+            std::copy(result.begin() + i * n, result.begin() + (i + 1) * n, batch.column(index[i]));
+        }
+    }
+
+    SpacetimeMultivector m_rotor;
+    std::array<float, 16> m_vector{};
+    std::array<float, 36> m_bivector{};
+};
+
+/**
+ * Hardware performance counters for kernel profiling.
+ *
+ * PerfCounters opens cycles, instructions, L1D read misses, LLC misses and
+ * branch misses for the calling thread through perf_event_open, user space
+ * only. Events the kernel refuses (no PMU under virtualization, a strict
+ * perf_event_paranoid) stay unavailable and read as zero while the others
+ * keep counting.
+ *
+ * The events are opened as one group led by the first that opens, so they
+ * are scheduled onto the PMU together; an event that cannot join counts on
+ * its own. When the kernel multiplexes the PMU, read() scales every count by
+ * its enabled / running time and multiplexed() reports that it did.
+ */
+class PerfCounters {
+public:
+    enum Event { Cycles, Instructions, L1DMisses, LLCMisses, BranchMisses, EventCount };
+
+    static constexpr const char *names[EventCount] = {
+        "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses",
+    };
+
+    using Sample = std::array<uint64_t, EventCount>;
+    using Availability = std::array<bool, EventCount>;
+
+    // Counters of the calling thread, opened on first use.
+    static PerfCounters &instance() {
+        thread_local PerfCounters counters;
+        return counters;
+    }
+
+    bool available(Event event) const {
+        return m_fds[event] >= 0;
+    }
+
+    Availability availability() const {
+        Availability result{};
+        for (size_t i = 0; i < EventCount; i++) {
+            result[i] = m_fds[i] >= 0;
+        }
+        return result;
+    }
+
+    Sample read() const {
+        Sample sample{};
+        m_multiplexed = false;
+        for (size_t i = 0; i < EventCount; i++) {
+            // PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING layout.
+            uint64_t value[3];
+            if (m_fds[i] < 0 || ::read(m_fds[i], value, sizeof(value)) != sizeof(value) || value[2] == 0) {
+                continue;
+            }
+            sample[i] = value[0];
+            if (value[2] < value[1]) {
+                sample[i] = static_cast<uint64_t>(static_cast<double>(value[0]) * value[1] / value[2]);
+                m_multiplexed = true;
+            }
+        }
+        return sample;
+    }
+
+    // Whether the last read() had to scale a multiplexed count.
+    bool multiplexed() const {
+        return m_multiplexed;
+    }
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    ~PerfCounters() {
+        for (int fd : m_fds) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+
+private:
+    PerfCounters() {
+        constexpr uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const std::pair<uint32_t, uint64_t> events[EventCount] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, l1d_read_miss},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        };
+        int leader = -1;
+        for (size_t i = 0; i < EventCount; i++) {
+            m_fds[i] = open(events[i].first, events[i].second, leader);
+            if (m_fds[i] < 0 && leader >= 0) {
+                m_fds[i] = open(events[i].first, events[i].second, -1);
+            }
+            if (leader < 0) {
+                leader = m_fds[i];
+            }
+        }
+    }
+
+    static int open(uint32_t type, uint64_t config, int group) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+    }
+
+    std::array<int, EventCount> m_fds;
+    mutable bool m_multiplexed = false;
+};
+
+// Metric of a signature as Cl(p,q,r), counting basis vectors whose square is
+// +1, -1 and 0 under the product (e(0) being minus the identity).
+template <class Signature>
+std::string signature_name() {
+    size_t counts[3] = {0, 0, 0};
+    for (size_t i = 0; i < Signature::max_dimension(); i++) {
+        int32_t s = Multivector<Signature>::sign(1ULL << i, 1ULL << i);
+        counts[s == 0 ? 2 : (s < 0 ? 0 : 1)]++;
+    }
+    return "Cl(" + std::to_string(counts[0]) + "," + std::to_string(counts[1]) + "," + std::to_string(counts[2]) + ")";
+}
+
+/**
+ * Per kernel and per signature aggregation of PerfCounters and wall time.
+ *
+ * A ProfileScope, KernelProfile::measure() or the ProfiledProduct strategy
+ * records one call each. Every record costs a few read() system calls, so
+ * profile whole products, sums and batch transforms rather than single blades.
+ */
+class KernelProfile {
+public:
+    struct Totals {
+        uint64_t calls = 0;
+        uint64_t nanoseconds = 0;
+        PerfCounters::Sample counters{};
+        // Counters that were open on any recording thread, and whether any
+        // recorded count was scaled for multiplexing.
+        PerfCounters::Availability available{};
+        bool multiplexed = false;
+    };
+
+    using Key = std::pair<std::string, std::string>;
+
+    static KernelProfile &instance() {
+        static KernelProfile profile;
+        return profile;
+    }
+
+    void record(const std::string &kernel, const std::string &signature, uint64_t nanoseconds,
+                const PerfCounters::Sample &counters, const PerfCounters::Availability &available,
+                bool multiplexed) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Totals &totals = m_totals[{kernel, signature}];
+        totals.calls++;
+        totals.nanoseconds += nanoseconds;
+        for (size_t i = 0; i < PerfCounters::EventCount; i++) {
+            totals.counters[i] += counters[i];
+            totals.available[i] = totals.available[i] || available[i];
+        }
+        totals.multiplexed = totals.multiplexed || multiplexed;
+    }
+
+    std::map<Key, Totals> snapshot() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_totals;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_totals.clear();
+    }
+
+    template <class F>
+    static decltype(auto) measure(const std::string &kernel, const std::string &signature, F &&f);
+
+    // Rows whose counts were scaled for multiplexing end in "scaled".
+    void report(std::ostream &os) const {
+        os << "kernel signature calls ns/call";
+        for (size_t i = 0; i < PerfCounters::EventCount; i++) {
+            os << " " << PerfCounters::names[i] << "/call";
+        }
+        os << "\n";
+        for (const auto &[key, totals] : snapshot()) {
+            os << key.first << " " << key.second << " " << totals.calls << " "
+               << static_cast<double>(totals.nanoseconds) / totals.calls;
+            for (size_t i = 0; i < PerfCounters::EventCount; i++) {
+                os << " ";
+                if (totals.available[i]) {
+                    os << static_cast<double>(totals.counters[i]) / totals.calls;
+                } else {
+                    os << "n/a";
+                }
+            }
+            os << (totals.multiplexed ? " scaled\n" : "\n");
+        }
+    }
+
+    // Unavailable counters are null.
+    void json(std::ostream &os) const {
+        os << "{\"kernels\":[";
+        bool first = true;
+        for (const auto &[key, totals] : snapshot()) {
+            os << (first ? "" : ",") << "{\"kernel\":" << quoted(key.first) << ",\"signature\":" << quoted(key.second)
+               << ",\"calls\":" << totals.calls << ",\"nanoseconds\":" << totals.nanoseconds;
+            for (size_t i = 0; i < PerfCounters::EventCount; i++) {
+                os << ",\"" << PerfCounters::names[i] << "\":";
+                if (totals.available[i]) {
+                    os << totals.counters[i];
+                } else {
+                    os << "null";
+                }
+            }
+            os << ",\"multiplexed\":" << (totals.multiplexed ? "true" : "false") << "}";
+            first = false;
+        }
+        os << "]}";
+    }
+
+    // JSON string literal.
+    static std::string quoted(const std::string &text) {
+        std::string result = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                result += '\\';
+            }
+            result += c;
+        }
+        return result + "\"";
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::map<Key, Totals> m_totals;
+};
+
+// Records the enclosed region into KernelProfile on destruction.
+class ProfileScope {
+public:
+    ProfileScope(std::string kernel, std::string signature)
+        : m_kernel(std::move(kernel)), m_signature(std::move(signature)),
+          m_start(PerfCounters::instance().read()), m_multiplexed(PerfCounters::instance().multiplexed()),
+          m_time(std::chrono::steady_clock::now()) {}
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+    ~ProfileScope() {
+        const PerfCounters &counters = PerfCounters::instance();
+        PerfCounters::Sample end = counters.read();
+        auto elapsed = std::chrono::steady_clock::now() - m_time;
+        for (size_t i = 0; i < PerfCounters::EventCount; i++) {
+            // Scaled estimates can step backwards between reads.
+            end[i] = end[i] > m_start[i] ? end[i] - m_start[i] : 0;
+        }
+        KernelProfile::instance().record(
+            m_kernel, m_signature,
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()), end,
+            counters.availability(), m_multiplexed || counters.multiplexed());
+    }
+
+private:
+    std::string m_kernel;
+    std::string m_signature;
+    PerfCounters::Sample m_start;
+    bool m_multiplexed;
+    std::chrono::steady_clock::time_point m_time;
+};
+
+template <class F>
+decltype(auto) KernelProfile::measure(const std::string &kernel, const std::string &signature, F &&f) {
+    ProfileScope scope(kernel, signature);
+    return std::forward<F>(f)();
+}
+
+/**
+ * Product strategy that profiles another one, e.g.
+ * Multivector::product<ProfiledProduct<BlockProduct>>(A, B).
+ */
+template <class Strategy>
+struct ProfiledProduct {
+    template <class Signature>
+    static Multivector<Signature> multiply(const Multivector<Signature> &A, const Multivector<Signature> &B) {
+        static const std::string kernel = kernel_name();
+        ProfileScope scope(kernel, signature_name<Signature>());
+        return Strategy::multiply(A, B);
+    }
+
+private:
+    static std::string kernel_name() {
+        int status = 0;
+        std::unique_ptr<char, void (*)(void *)> name(
+            abi::__cxa_demangle(typeid(Strategy).name(), nullptr, nullptr, &status), std::free);
+        return status == 0 ? name.get() : typeid(Strategy).name();
+    }
+};